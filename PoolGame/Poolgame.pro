@@ -4,13 +4,24 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = Poolgame
 TEMPLATE = app
 
+# the physics is single precision by default, qmake CONFIG+=accurate builds it in double precision (see physics.h)
+accurate {
+    DEFINES += POOLGAME_ACCURATE
+    TARGET = Poolgame_accurate
+}
+
+# qmake CONFIG+=allocations counts every heap allocation, for Poolgame --check-allocations (see alloccount.h)
+allocations {
+    DEFINES += POOLGAME_COUNT_ALLOCATIONS
+}
+
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which has been marked as deprecated (the exact warnings
 # depend on your compiler). Please consult the documentation of the
@@ -34,9 +45,21 @@ SOURCES += \
     stagetwofactory.cpp \
     pocket.cpp \
     stagetwobuilder.cpp \
-    balldecorator.cpp \
+    ballbehaviours.cpp \
     strategy.cpp \
-    visiter.cpp
+    visiter.cpp \
+    scenariocache.cpp \
+    jsonpullreader.cpp \
+    streaminggamedirector.cpp \
+    ensemble.cpp \
+    timeline.cpp \
+    occlusion.cpp \
+    governor.cpp \
+    camera.cpp \
+    tilerenderer.cpp \
+    alloccount.cpp \
+    eventstream.cpp \
+    contactcache.cpp
 
 HEADERS += \
         dialog.h \
@@ -50,12 +73,25 @@ HEADERS += \
     stagetwofactory.h \
     pocket.h \
     stagetwobuilder.h \
-    balldecorator.h \
+    ballbehaviours.h \
     mouseeventable.h \
     memento.h \
     originator.h \
     strategy.h \
-    visiter.h
+    visiter.h \
+    scenariocache.h \
+    jsonpullreader.h \
+    streaminggamedirector.h \
+    ensemble.h \
+    timeline.h \
+    physics.h \
+    occlusion.h \
+    governor.h \
+    camera.h \
+    tilerenderer.h \
+    alloccount.h \
+    eventstream.h \
+    contactcache.h
 
 FORMS += \
         dialog.ui
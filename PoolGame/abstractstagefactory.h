@@ -13,6 +13,12 @@ public:
      * @return our newly created ball
      */
     virtual Ball* makeBall(const QJsonObject& ballData) = 0;
+    /**
+     * @brief makeBallNode - construct the blueprint for a nested ball based on the json provided
+     * @param ballData - json that conforms to the spec
+     * @return the blueprint node, with no parent, and offset set to its position
+     */
+    virtual BallNode makeBallNode(const QJsonObject& ballData) = 0;
     /**
      * @brief makeTable - construct a table based on json provided
      * @param tableData - json that conforms to the spec
@@ -0,0 +1,39 @@
+#include "alloccount.h"
+
+#ifdef POOLGAME_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// zero initialised, so it's ready before any static constructor allocates
+static std::atomic<size_t> allocations(0);
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    // malloc(0) may return nullptr, new can't
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+// everything else (new[], the nothrow versions, sized delete) goes through these two
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+bool AllocationCounter::enabled() {
+    return true;
+}
+
+size_t AllocationCounter::count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+#else
+bool AllocationCounter::enabled() {
+    return false;
+}
+
+size_t AllocationCounter::count() {
+    return 0;
+}
+#endif
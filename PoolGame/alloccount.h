@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief The AllocationCounter class
+ * Counts every operator new of the program, but only when it's built with qmake CONFIG+=allocations
+ *  (the counting replaces the global operator new). Used by --check-allocations to make sure that
+ *  a physics step with nothing breaking or being spawned doesn't touch the heap.
+ */
+class AllocationCounter {
+public:
+    /* whether allocations are counted at all, i.e. whether this is an allocations build */
+    static bool enabled();
+    /* how many allocations there have been so far, on any thread */
+    static size_t count();
+};
@@ -1,52 +1,131 @@
 #include "ball.h"
 #include <iostream>
 
-void StageOneBall::render(QPainter &painter, const QVector2D& offset) {
+void Ball::flattenInto(std::vector<BallNode> &out, int parent, const QVector2D &origin) {
+    // plain balls never break, so they are unbreakable once flattened. nested balls can't be cue balls
+    out.push_back(BallNode{m_brush.color(), origin + getPosition(), m_mass, m_radius,
+                           std::numeric_limits<double>::max(), parent, 1, m_behaviours & ~CueBehaviour});
+}
+
+void StageOneBall::render(QPainter &painter, const QVector2D& offset) const {
     // use our colour
     painter.setBrush(m_brush);
     // circle centered
-    painter.drawEllipse((offset + m_pos).toPointF(), m_radius, m_radius);
+    painter.drawEllipse((offset + getPosition()).toPointF(), m_radius, m_radius);
 }
 
 Ball* CompositeBall::clone(){
-    CompositeBall* ball = new CompositeBall(*this);
+    // the blueprint is immutable, so sharing it clones the whole subtree
+    return new CompositeBall(*this);
+}
+
+BallBlueprint CompositeBall::getChildren() const {
+    BallBlueprint blueprint;
+    blueprint.reserve(m_count);
+    flattenChildrenInto(blueprint, -1, QVector2D());
+    return blueprint;
+}
 
-    //clone all the childrean balls as well
-    for(int i = 0; i < m_children.size(); i++){
-        ball->addChild(m_children.at(i)->clone());
+void CompositeBall::setChildren(std::shared_ptr<const BallBlueprint> blueprint) {
+    m_blueprint = blueprint;
+    m_first = 0;
+    m_count = blueprint->size();
+    m_origin = QVector2D();
+}
+
+void CompositeBall::addChild(Ball *b) {
+    // copy-on-write, the blueprint may be shared with our clones
+    std::shared_ptr<BallBlueprint> blueprint = std::make_shared<BallBlueprint>();
+    flattenChildrenInto(*blueprint, -1, QVector2D());
+    b->flattenInto(*blueprint, -1, QVector2D());
+    delete b;
+    setChildren(blueprint);
+}
+
+void CompositeBall::scale(double massFactor, double strengthFactor) {
+    Ball::scale(massFactor, strengthFactor);
+    m_strength *= strengthFactor;
+    if (m_count == 0) return;
+    // copy-on-write, the blueprint may be shared with our clones
+    std::shared_ptr<BallBlueprint> blueprint = std::make_shared<BallBlueprint>(getChildren());
+    for (BallNode& n : *blueprint) {
+        n.mass *= massFactor;
+        n.strength *= strengthFactor;
     }
-    return ball;
+    setChildren(blueprint);
 }
 
-void CompositeBall::render(QPainter &painter, const QVector2D& offset) {
-    recursiveRender(painter, offset);
+void CompositeBall::flattenChildrenInto(std::vector<BallNode> &out, int parent, const QVector2D &origin) const {
+    const int base = out.size();
+    for (size_t i = m_first; i < m_first + m_count; ++i) {
+        BallNode n = m_blueprint->at(i);
+        // anything outside of our slice is the node we were released from (or nothing), i.e. us
+        n.parent = n.parent < (int) m_first ? parent : base + n.parent - (int) m_first;
+        n.offset += origin - m_origin;
+        out.push_back(n);
+    }
+}
+
+void CompositeBall::flattenInto(std::vector<BallNode> &out, int parent, const QVector2D &origin) {
+    const int self = out.size();
+    const QVector2D pos = origin + getPosition();
+    out.push_back(BallNode{m_brush.color(), pos, m_mass, m_radius, m_strength,
+                           parent, 1 + (int) m_count, m_behaviours & ~CueBehaviour});
+    flattenChildrenInto(out, self, pos);
 }
 
-void CompositeBall::recursiveRender(QPainter &painter, const QVector2D &offset) {
+void CompositeBall::render(QPainter &painter, const QVector2D& offset) const {
     // use our colour
     painter.setBrush(m_brush);
 
     // circle centered, plus offset
-    painter.drawEllipse((offset + m_pos).toPointF(), m_radius, m_radius);
+    painter.drawEllipse((offset + getPosition()).toPointF(), m_radius, m_radius);
 
-    // render children potentially
-    if (m_renderChildren) for (Ball* b : m_children) b->render(painter, offset + m_pos);
+    // render children potentially (preorder, so parents are still drawn beneath their children)
+    if (!m_renderChildren || m_count == 0) return;
+    const QVector2D origin = offset + getPosition() - m_origin;
+    for (size_t i = m_first; i < m_first + m_count; ++i) {
+        const BallNode& n = m_blueprint->at(i);
+        painter.setBrush(n.colour);
+        painter.drawEllipse((origin + n.offset).toPointF(), n.radius, n.radius);
+    }
 }
 
-bool CompositeBall::applyBreak(const QVector2D &deltaV, std::vector<Ball *> &parentlist) {
-    double energyOfCollision = m_mass*deltaV.lengthSquared();
+Ball* CompositeBall::releaseChild(size_t i) const {
+    const BallNode& node = m_blueprint->at(i);
+    CompositeBall* ball = new CompositeBall(node.colour, node.offset - m_origin, QVector2D(),
+                                            node.mass, node.radius, node.strength);
+
+    // our subtree is the slice directly after us, so no copying required
+    ball->m_blueprint = m_blueprint;
+    ball->m_first = i + 1;
+    ball->m_count = node.subtreeSize - 1;
+    ball->m_origin = node.offset;
+    ball->addBehaviours(node.behaviours);
+    return ball;
+}
+
+bool CompositeBall::applyBreak(const Vector &deltaV, std::vector<Ball *> &parentlist) {
+    Real energyOfCollision = m_mass*deltaV.lengthSquared();
     if (energyOfCollision >= m_strength) {
-        if (m_children.empty()) return true;
+        if (m_count == 0) return true;
+
+        // direct children are found by skipping over each subtree
+        const size_t end = m_first + m_count;
+        size_t numDirectChildren = 0;
+        for (size_t i = m_first; i < end; i += m_blueprint->at(i).subtreeSize) ++numDirectChildren;
 
         // undo the delta to find the precollision velocity
-        QVector2D preCollisionVelocity = m_velocity - deltaV;
-        double energyPerBall = energyOfCollision/m_children.size();
-        QVector2D pointOfCollision((-deltaV.normalized())*m_radius);
+        Vector preCollisionVelocity = m_velocity - deltaV;
+        Real energyPerBall = energyOfCollision/numDirectChildren;
+        Vector pointOfCollision((-deltaV.normalized())*Real(m_radius));
         // explode balls away from point of impact
-        for (Ball* b : m_children) {
+        for (size_t i = m_first; i < end; i += m_blueprint->at(i).subtreeSize) {
+            // only now do the children become real balls
+            Ball* b = releaseChild(i);
             b->setVelocity(preCollisionVelocity +
-                           sqrt(energyPerBall/b->getMass())*
-                           (b->getPosition()-pointOfCollision).normalized());
+                           std::sqrt(energyPerBall/b->getMass())*
+                           (b->position()-pointOfCollision).normalized());
             // move the ball to be absolute
             b->translate(m_pos);
             parentlist.push_back(b);
@@ -4,20 +4,51 @@
 #include <cmath>
 #include <QPainter>
 #include <QVector2D>
+#include "physics.h"
+#include <limits>
+#include <vector>
+#include <memory>
+
+// optional behaviours a ball can have. the state for these lives in components owned by the game
+enum BallBehaviour { NoBehaviour = 0, CueBehaviour = 1 << 0, SparkleBehaviour = 1 << 1, SmashBehaviour = 1 << 2 };
+
+/**
+ * @brief The BallNode struct - a compact description of a ball inside a CompositeBall's blueprint.
+ *  Blueprints are laid out in preorder, so the subtree of node i is exactly the slice [i, i + subtreeSize).
+ *  Nodes only become real Balls once their parent breaks
+ */
+struct BallNode {
+    QColor colour;
+    // position relative to the composite ball that owns the blueprint
+    QVector2D offset;
+    double mass;
+    int radius;
+    double strength;
+    // blueprint index of the parent node, or -1 if the parent is the owning composite itself
+    int parent;
+    // number of nodes in this subtree, including this node
+    int subtreeSize;
+    // BallBehaviour flags the ball gets once it breaks free
+    int behaviours;
+};
+
+// a composite's children, flattened. never modified once shared between balls
+typedef std::vector<BallNode> BallBlueprint;
 
 class Ball {
 protected:
     QBrush m_brush;
-    QVector2D m_pos;
-    QVector2D m_velocity;
-    double m_mass;
+    // in the physics' precision, see physics.h
+    Vector m_pos;
+    Vector m_velocity;
+    Real m_mass;
     int m_radius;
-    //if the ball is the cue ball or not
-    bool m_cue = false;
-
+    // BallBehaviour flags, i.e. whether we're the cue ball, sparkle, etc.
+    int m_behaviours = NoBehaviour;
+public:
     // if movement is slower than this, then we're considered at a stand-still
     static constexpr double MovementEpsilon = 1;
-public:
+
     virtual ~Ball() {}
     Ball(QColor colour, QVector2D position,
          QVector2D velocity, double mass, int radius) :
@@ -25,7 +56,7 @@ public:
         m_mass(mass), m_radius(radius){}
     //copy constructor
     Ball(Ball& ball): m_brush(ball.m_brush), m_pos(ball.m_pos), m_velocity(ball.m_velocity),
-        m_mass(ball.m_mass), m_radius(ball.m_radius), m_cue(ball.m_cue){}
+        m_mass(ball.m_mass), m_radius(ball.m_radius), m_behaviours(ball.m_behaviours){}
     Ball() {}
 
     /**
@@ -37,38 +68,72 @@ public:
      * @brief render - draw the ball to the screen
      * @param painter - QPainter that is owned by the dialog
      */
-    virtual void render(QPainter &painter, const QVector2D& offset) = 0;
+    virtual void render(QPainter &painter, const QVector2D& offset) const = 0;
     /**
      * @brief translate - Move the ball's position by provided vector
      * @param vec - vector
      */
-    virtual void translate(QVector2D vec) { m_pos += vec; }
+    void translate(QVector2D vec) { m_pos += Vector(vec); }
+    void translate(const Vector& vec) { m_pos += vec; }
 
-    virtual QVector2D getVelocity() const { return m_velocity; }
-    virtual void setVelocity(QVector2D v) { m_velocity = v; }
+    // the physics only ever touches these, so they're plain (non-virtual) accessors
+    QVector2D getVelocity() const { return m_velocity.toQVector2D(); }
+    void setVelocity(QVector2D v) { m_velocity = Vector(v); }
+    void setVelocity(const Vector& v) { m_velocity = v; }
     /**
      * @brief changeVelocity - modify speed by a constant amount
      * @param delta - change in velocity (x,y)
      */
-    virtual void changeVelocity(const QVector2D& delta) { m_velocity += delta; }
+    void changeVelocity(const QVector2D& delta) { m_velocity += Vector(delta); }
+    void changeVelocity(const Vector& delta) { m_velocity += delta; }
     /**
      * @brief multiplyVelocity - apply vector multiplicatively
      * @param vel - vector
      */
-    virtual void multiplyVelocity(const QVector2D& vel) { m_velocity *= vel; }
+    void multiplyVelocity(const Vector& vel) { m_velocity *= vel; }
+    /* the physics' own copies of our position & velocity, without converting them to QVector2D */
+    const Vector& position() const { return m_pos; }
+    const Vector& velocity() const { return m_velocity; }
+    Vector& position() { return m_pos; }
+    Vector& velocity() { return m_velocity; }
+    /* whether we're considered to be moving at all */
+    bool isMoving() const { return m_velocity.length() > MovementEpsilon; }
+
+    bool isCue() const {return m_behaviours & CueBehaviour;}
+    void setCue() {m_behaviours |= CueBehaviour;}
+    /* BallBehaviour flags */
+    int getBehaviours() const { return m_behaviours; }
+    bool hasBehaviour(BallBehaviour b) const { return m_behaviours & b; }
+    void addBehaviours(int behaviours) { m_behaviours |= behaviours; }
+
+    Real getMass() const { return m_mass; }
+    int getRadius() const { return m_radius; }
+    QVector2D getPosition() const { return m_pos.toQVector2D(); }
+    QColor getColour() const { return m_brush.color(); }
+    void setPosition(QVector2D p) { m_pos = Vector(p); }
+    void setPosition(const Vector& p) { m_pos = p; }
 
-    virtual bool isCue() {return m_cue;}
-    virtual void setCue() {m_cue = true;}
+    /**
+     * @brief scale - multiply our mass (and strength, if we can break), along with everything inside of us
+     * @param massFactor - mass multiplier
+     * @param strengthFactor - strength multiplier, unused by balls that don't break
+     */
+    virtual void scale(double massFactor, double) { m_mass *= massFactor; }
 
-    virtual double getMass() const { return m_mass; }
-    virtual int getRadius() const { return m_radius; }
-    virtual QVector2D getPosition() const { return m_pos; }
-    //virtual QColor getColour() const{return m_brush;}
-    virtual void setPosition(QVector2D p) { m_pos = p; }
+    /* whether the balls nested inside of us are drawn, for balls that have any */
+    virtual void setRenderChildren(bool) {}
 
     // whether the ball will break, and handle accordingly
     // for base ball, do nothing. insert into rhs if necessary
-    virtual bool applyBreak(const QVector2D&, std::vector<Ball*>&) { return false; }
+    virtual bool applyBreak(const Vector&, std::vector<Ball*>&) { return false; }
+
+    /**
+     * @brief flattenInto - append this ball (and everything it contains) to a flattened child array
+     * @param out - the array to append to
+     * @param parent - index of the parent node in out, or -1 if the parent owns the array
+     * @param origin - position of our parent relative to the owner of the array
+     */
+    virtual void flattenInto(std::vector<BallNode>& out, int parent, const QVector2D& origin);
 };
 
 class StageOneBall : public Ball {
@@ -82,31 +147,63 @@ public:
      * @brief render - draw the ball to the screen
      * @param painter - QPainter that is owned by the dialog
      */
-    void render(QPainter &painter, const QVector2D& offset) override;
+    void render(QPainter &painter, const QVector2D& offset) const override;
 };
 
 class CompositeBall : public Ball {
 protected:
-    std::vector<Ball*> m_children;
+    // the (shared, immutable) blueprint that our children live in, see BallNode
+    std::shared_ptr<const BallBlueprint> m_blueprint;
+    // our children are the slice [m_first, m_first + m_count) of the blueprint
+    size_t m_first = 0;
+    size_t m_count = 0;
+    // blueprint offsets are relative to the blueprint's owner, this is our offset within it
+    QVector2D m_origin;
     bool m_renderChildren = true;
-    void recursiveRender(QPainter& painter, const QVector2D& offset);
     // default is unbreakable (i.e. inf str)
     double m_strength = std::numeric_limits<double>::max();
+
+    /**
+     * @brief releaseChild - instantiate the blueprint node at index i as a standalone ball.
+     *  The new ball shares our blueprint, its children are simply the slice after i
+     * @param i - index of a node in the blueprint
+     * @return the new ball, positioned relative to us, with the node's behaviours
+     */
+    Ball* releaseChild(size_t i) const;
+
+    /**
+     * @brief flattenChildrenInto - append a rebased copy of our slice of the blueprint
+     * @param out - the blueprint to append to
+     * @param parent - index in out that our direct children should point at
+     * @param origin - our position relative to the owner of out
+     */
+    void flattenChildrenInto(std::vector<BallNode>& out, int parent, const QVector2D& origin) const;
 public:
     CompositeBall(QColor colour, QVector2D position,
                  QVector2D velocity, double mass, int radius, double strength) :
         Ball(colour, position, velocity, mass, radius), m_strength(strength) {}
-    CompositeBall(CompositeBall& ball): Ball(ball), m_strength(ball.m_strength){}
+    CompositeBall(CompositeBall& ball): Ball(ball), m_blueprint(ball.m_blueprint),
+        m_first(ball.m_first), m_count(ball.m_count), m_origin(ball.m_origin),
+        m_renderChildren(ball.m_renderChildren), m_strength(ball.m_strength){}
 
     Ball* clone() override;
     /**
      * @brief render - draw the ball to the screen
      * @param painter - QPainter that is owned by the dialog
      */
-    void render(QPainter &painter, const QVector2D& offset) override;
+    void render(QPainter &painter, const QVector2D& offset) const override;
+
+    /* add a child ball to this composite ball. the ball is flattened into our blueprint and deleted */
+    void addChild(Ball* b);
+
+    /* our children, as a standalone blueprint (nodes with parent -1 are our direct children) */
+    BallBlueprint getChildren() const;
+    /* how many nested balls we have in total */
+    size_t getChildCount() const { return m_count; }
+    double getStrength() const { return m_strength; }
 
-    /* add a child ball to this composite ball */
-    void addChild(Ball* b) { m_children.push_back(b); }
+    /* take the whole blueprint as our children. nodes with parent -1 are our direct children */
+    void setChildren(std::shared_ptr<const BallBlueprint> blueprint);
 
     /**
      * @brief applyBreak - check and resolve breaking balls
@@ -114,5 +211,11 @@ public:
      * @param parentlist - the list of balls that we'll need to add to if we break anything
      * @return whether the ball broke or not
      */
-    virtual bool applyBreak(const QVector2D& deltaV, std::vector<Ball*>& parentlist) override;
+    virtual bool applyBreak(const Vector& deltaV, std::vector<Ball*>& parentlist) override;
+
+    void flattenInto(std::vector<BallNode>& out, int parent, const QVector2D& origin) override;
+
+    void scale(double massFactor, double strengthFactor) override;
+
+    void setRenderChildren(bool render) override { m_renderChildren = render; }
 };
@@ -0,0 +1,160 @@
+#include "ballbehaviours.h"
+#include <algorithm>
+
+CueBall *CueBall::clone(Ball* ball){
+    ball->setVelocity(QVector2D()); //set cue velocity to 0
+    ball->setPosition(posToSave); //set position to last saved point
+    CueBall* cue = new CueBall(ball);
+    return cue;
+}
+
+void CueBall::render(QPainter &painter) const {
+    // no line while we're moving at all (the drag is cancelled on the next step)
+    if (isDragging && !m_ball->isMoving()) {
+        painter.drawLine(m_startMousePos.toPointF(), m_endMousePos.toPointF());
+    }
+}
+
+void CueBall::mouseClickEvent(QMouseEvent* e) {
+
+    QVector2D p = QVector2D(e->localPos());
+
+    // don't allow movement if moving
+    if (m_ball->isMoving()) {
+        // can't be too sure
+        isDragging = false;
+        return;
+    }
+
+    m_startMousePos = p;
+    m_endMousePos = p;
+
+    // note this treats it as absolute distance
+    // check whether the click isn't on the ball
+    if (m_startMousePos.distanceToPoint(m_ball->getPosition()) > m_ball->getRadius()) return;
+
+    isDragging = true;
+
+}
+
+void CueBall::mouseMoveEvent(QMouseEvent* e) {
+    QVector2D p = QVector2D(e->localPos());
+
+    if (m_ball->isMoving()) {
+        isDragging = false;
+        return;
+    }
+    m_endMousePos = p;
+}
+
+void CueBall::mouseReleaseEvent(QMouseEvent* e) {
+
+    QVector2D p = QVector2D(e->localPos());
+    
+    // only draw & move if we're allowing the draw action to go ahead
+    if (isDragging) {
+        // velocity is the vector that the mouse drew
+        m_save = true;
+        posToSave = m_ball->getPosition();
+        m_endMousePos = p;
+        QVector2D resultingVel = m_endMousePos - posToSave;
+        isDragging = false;
+        // update ball vel
+        m_ball->changeVelocity(resultingVel);
+        m_struck = true;
+    }
+}
+
+void BallEffects::addCrumbs(QPointF cPos, std::mt19937& rng) {
+    size_t numAdding = rng() % 10;
+    for (size_t i = 0; i < numAdding; ++i) {
+        double width = (rng()%100)/20.0;
+        double height = (rng()%100)/20.0;
+        QVector2D dir(int(rng()%10)-5, int(rng()%10)-5);
+        m_crumbs.push_back(Crumb(cPos, width, height, dir));
+    }
+}
+
+int BallEffects::jitter(unsigned seed, unsigned age) {
+    // a cheap integer hash, rand() would make every frame different (and isn't thread safe)
+    unsigned h = (seed ^ (age * 0x9E3779B9u)) * 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return int(h % 6) - 3;
+}
+
+void BallEffects::crumble(const PhysicsEvent::Subject &ball, bool wall, std::mt19937& rng) {
+    if (!(ball.behaviours & SmashBehaviour)) return;
+    // whenever a velocity changes a lot, or we bounce off a wall, we should add some particles
+    if (wall || ball.deltaV > smashThreshold) addCrumbs(ball.position.toPointF(), rng);
+}
+
+void BallEffects::consume(const std::vector<PhysicsEvent> &events, std::mt19937& rng) {
+    for (const PhysicsEvent& e : events) {
+        if (e.type == PhysicsEvent::WallHit) {
+            crumble(e.ball, true, rng);
+        } else if (e.type == PhysicsEvent::Collision) {
+            crumble(e.ball, false, rng);
+            crumble(e.other, false, rng);
+        }
+    }
+}
+
+void BallEffects::update(const std::vector<Ball*> &balls, std::mt19937& rng) {
+    for (const Ball* b : balls) {
+        if (b == nullptr || !b->hasBehaviour(SparkleBehaviour)) continue;
+        // 1/10 chance to make a new sparkle (must be moving)
+        const unsigned roll = rng();
+        if (roll % 10 == 0 && b->getVelocity().length() >= Ball::MovementEpsilon) {
+            m_sparkles.push_back(Sparkle(b->getPosition().toPointF(), roll / 10));
+        }
+    }
+
+    for (Sparkle& s : m_sparkles) {
+        s.opacity -= fadeRate;
+        ++s.age;
+    }
+    for (Crumb& c : m_crumbs) {
+        // move the crummie
+        c.pos += (c.dir*moveRate).toPointF();
+        c.opacity -= fadeRate;
+    }
+
+    // remove when non-visible
+    m_sparkles.erase(std::remove_if(m_sparkles.begin(), m_sparkles.end(),
+                                    [](const Sparkle& s) { return s.opacity <= 0; }), m_sparkles.end());
+    m_crumbs.erase(std::remove_if(m_crumbs.begin(), m_crumbs.end(),
+                                  [](const Crumb& c) { return c.opacity <= 0; }), m_crumbs.end());
+}
+
+void BallEffects::render(QPainter &painter, const QVector2D &offset, const QRectF& view, size_t cap) const {
+    // the newest particles are at the back, and are the most visible
+    const size_t crumbs = std::min(cap, m_crumbs.size());
+    const size_t sparkles = std::min(cap - crumbs, m_sparkles.size());
+
+    painter.setBrush(QBrush(QColor("yellow")));
+    for (auto it = m_sparkles.end() - sparkles; it != m_sparkles.end(); ++it) {
+        const Sparkle& s = *it;
+        painter.setOpacity(s.opacity);
+        // 5x5 mini rect randomly oscillating
+        QRectF r(offset.x() + s.pos.x() + jitter(2*s.seed, s.age),
+                 offset.y() + s.pos.y() + jitter(2*s.seed + 1, s.age), s.width , s.height);
+        if (!view.isNull() && !view.intersects(r)) continue;
+        painter.drawRect(r);
+    }
+
+    // draw the crummies
+    painter.setBrush(QBrush(QColor("gray")));
+    for (auto it = m_crumbs.end() - crumbs; it != m_crumbs.end(); ++it) {
+        const Crumb& c = *it;
+        painter.setOpacity(c.opacity);
+        // our lil crumb object
+        QRectF r(offset.x() + c.pos.x(),
+                 offset.y() + c.pos.y(), c.width, c.height);
+        if (!view.isNull() && !view.intersects(r)) continue;
+        painter.drawRect(r);
+    }
+    // reset to opaque
+    painter.setOpacity(1);
+}
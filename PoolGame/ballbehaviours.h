@@ -0,0 +1,197 @@
+#pragma once
+
+#include "ball.h"
+#include "utils.h"
+#include "mouseeventable.h"
+#include "eventstream.h"
+#include <random>
+
+/**
+ * @brief The CueBall class
+ * The cue behaviour component. This handles some mouse interactions, and can control the position/velocity of the ball
+ * The ball will only be able to be controlled if the mouse click&drag event originated at
+ * the position of the cue ball.
+ */
+class CueBall : public MouseEventable {
+protected:
+    // the ball we're controlling, owned by the game
+    Ball* m_ball;
+    QVector2D posToSave;
+    bool m_save = false;
+    // whether we've been shot since the game last asked
+    bool m_struck = false;
+    // keep track of where the mouse click started at
+    QVector2D m_startMousePos;
+    // and the end
+    QVector2D m_endMousePos;
+    // whether the drag is happening
+    bool isDragging = false;
+
+public:
+    CueBall(Ball* b) : MouseEventable(this), m_ball(b), posToSave(b->getPosition()) {
+        m_ball->setCue();
+    }
+    ~CueBall() {}
+
+    /**
+     * @return the ball that is being controlled
+     */
+    Ball* ball() const { return m_ball; }
+
+    /**
+     * @return if the game need to be saved
+     */
+    bool save(){return m_save;}
+
+    /**
+     * @brief notSave called when the game has been saved once
+     */
+    void notSave(){m_save = false;}
+
+    /**
+     * @brief takeStrike - whether the ball has been shot since the last time this was called
+     */
+    bool takeStrike() {
+        const bool struck = m_struck;
+        m_struck = false;
+        return struck;
+    }
+    /* the ball was shot some other way, i.e. a shot being replayed */
+    void setStruck() { m_struck = true; }
+
+    /**
+     * @return where the ball was before the last shot, i.e. where undo puts it back
+     */
+    QVector2D savedPosition() const { return posToSave; }
+    /* whether a shot is being lined up */
+    bool dragging() const { return isDragging; }
+    void setSavedPosition(QVector2D p) { posToSave = p; }
+
+    /**
+     * @brief clone of current cue ball, to control a clone of our ball
+     * @param ball - the cloned ball. it is reset to the last saved point, at rest
+     * @return new cue ball with same value
+     */
+    CueBall* clone(Ball* ball);
+
+    /**
+     * @brief render - draw the drag indicator if applicable
+     * @param painter - the brush to use to draw
+     */
+    void render(QPainter &painter) const;
+
+    /**
+     * @brief step - called every step of the game, a shot can't be lined up while the ball is moving
+     */
+    void step() { if (m_ball->isMoving()) isDragging = false; }
+
+public:
+    /**
+     * @brief mouseClickEvent - update where the start of the mouse drag is.
+     *      Chooses not to draw IF the click is not within bounds
+     * @param e - the mouse event caused by clicking
+     */
+    virtual void mouseClickEvent(QMouseEvent* e) override;
+    
+    /**
+     * @brief mouseMoveEvent - update where the current end of the mouse drag is.
+     *      Used when the mouse is moved, i.e. not released, but dragged.
+     * @param e - the mouse event caused by clicking
+     */
+    virtual void mouseMoveEvent(QMouseEvent* e) override;
+
+    /**
+     * @brief mouseReleaseEvent - update where the end of the mouse drag is, & release the click
+     *  This will update the ball velocity if drawn.
+     * @param e - the mouse event caused by clicking
+     */
+    virtual void mouseReleaseEvent(QMouseEvent* e) override;
+};
+
+/**
+ * @brief The BallEffects class
+ * The particle component for the sparkle and smash behaviours of all balls in a game.
+ *  Particles are in absolute positions, so they outlive the balls that made them
+ */
+class BallEffects {
+protected:
+    // our particle that is drawn
+    struct Sparkle {
+        Sparkle( QPointF pos, unsigned seed)
+            :pos(pos), seed(seed){}
+        // absolute position
+        QPointF pos;
+        double opacity = 1.0;
+        double width = 5.0;
+        double height = 5.0;
+        // where it jitters to is a function of these, so drawing a frame twice (or in parts) draws the same thing
+        unsigned seed;
+        unsigned age = 0;
+    };
+
+    struct Crumb {
+        Crumb(QPointF cPos,double width,double height,QVector2D dir, double opacity = 1.0)
+            :pos(cPos),width(width),height(height),dir(dir),opacity(opacity){}
+
+        // absolute position (from origin)
+        QPointF pos;
+        double width = 5.0;
+        double height = 5.0;
+        // particle tween direction
+        QVector2D dir;
+        double opacity = 1.0;
+    };
+
+    // how fast the opacity is faded per frame.
+    // yes, this is frame dependent.
+    static constexpr double fadeRate = 0.01;
+    // rate of escape of crumbs
+    static constexpr double moveRate = 0.3;
+    // a velocity change larger than this makes a smash ball crumble
+    static constexpr double smashThreshold = 3.0;
+
+    // our particle effects that will be drawn per frame
+    std::vector<Sparkle> m_sparkles;
+    std::vector<Crumb> m_crumbs;
+
+    void addCrumbs(QPointF cPos, std::mt19937& rng);
+
+    /**
+     * @brief crumble - a smash ball crumbles when it hits a wall, or its velocity changes a lot
+     * @param ball - the ball the event happened to
+     * @param wall - whether it hit a wall
+     */
+    void crumble(const PhysicsEvent::Subject& ball, bool wall, std::mt19937& rng);
+
+    /* how far a sparkle is jittered along one axis, in [-3, 3) */
+    static int jitter(unsigned seed, unsigned age);
+public:
+    /**
+     * @brief consume - react to what happened during the last physics step (smash balls crumble)
+     * @param events - the events of the step
+     * @param rng - the game's random source
+     */
+    void consume(const std::vector<PhysicsEvent>& events, std::mt19937& rng);
+
+    /**
+     * @brief update - move & fade the particles, and trail sparkles behind moving sparkle balls
+     * @param balls - all of the balls in the game
+     * @param rng - the game's random source
+     */
+    void update(const std::vector<Ball*>& balls, std::mt19937& rng);
+
+    /* how many particles there are */
+    size_t size() const { return m_sparkles.size() + m_crumbs.size(); }
+    /* whether every particle has faded away */
+    bool idle() const { return m_sparkles.empty() && m_crumbs.empty(); }
+
+    /**
+     * @brief render - draw all of the particles
+     * @param painter - the brush to use to draw
+     * @param offset - the offset from the window that the particle positions are
+     * @param view - the part of the table that can be seen, a null rect to draw everything
+     * @param cap - most particles to draw, the newest ones (crumbs first)
+     */
+    void render(QPainter &painter, const QVector2D &offset, const QRectF& view = QRectF(),
+                size_t cap = std::numeric_limits<size_t>::max()) const;
+};
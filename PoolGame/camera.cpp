@@ -0,0 +1,44 @@
+#include "camera.h"
+#include <algorithm>
+
+constexpr double Camera::MinZoom;
+constexpr double Camera::MaxZoom;
+
+void Camera::fit(const QSizeF &world) {
+    m_centre = QVector2D(world.width() / 2, world.height() / 2);
+    if (world.isEmpty() || m_viewport.isEmpty()) return;
+    const double zoom = std::min(m_viewport.width() / world.width(), m_viewport.height() / world.height());
+    m_zoom = std::max(MinZoom, std::min(MaxZoom, zoom));
+}
+
+void Camera::pan(const QPointF &screenDelta) {
+    // dragging the table right moves what we're looking at left
+    m_centre -= QVector2D(screenDelta) / m_zoom;
+}
+
+void Camera::zoomAt(const QPointF &screen, double factor) {
+    const QVector2D before = toWorld(screen);
+    m_zoom = std::max(MinZoom, std::min(MaxZoom, m_zoom * factor));
+    // move so that the point is under the mouse again
+    m_centre += before - toWorld(screen);
+}
+
+QVector2D Camera::toWorld(const QPointF &screen) const {
+    const QPointF fromMiddle = screen - QPointF(m_viewport.width() / 2, m_viewport.height() / 2);
+    return m_centre + QVector2D(fromMiddle) / m_zoom;
+}
+
+QRectF Camera::toWorld(const QRectF &screen) const {
+    return QRectF(toWorld(screen.topLeft()).toPointF(), toWorld(screen.bottomRight()).toPointF());
+}
+
+QRectF Camera::visible() const {
+    const QSizeF size = m_viewport / m_zoom;
+    return QRectF(m_centre.x() - size.width() / 2, m_centre.y() - size.height() / 2, size.width(), size.height());
+}
+
+void Camera::apply(QPainter &painter) const {
+    painter.translate(m_viewport.width() / 2, m_viewport.height() / 2);
+    painter.scale(m_zoom, m_zoom);
+    painter.translate(-m_centre.x(), -m_centre.y());
+}
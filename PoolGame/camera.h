@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
+#include <QVector2D>
+
+/**
+ * @brief The Camera class
+ * Which part of the table the window shows, and how large. The game is always in table
+ *  coordinates, the camera maps between those and the window's (screen) coordinates.
+ */
+class Camera {
+public:
+    static constexpr double MinZoom = 0.02;
+    static constexpr double MaxZoom = 8.0;
+
+    /**
+     * @brief setViewport - the size of the window, the centre stays where it is
+     */
+    void setViewport(const QSizeF& size) { m_viewport = size; }
+
+    /**
+     * @brief fit - show all of the area, centred
+     * @param world - the size of the area, i.e. the table
+     */
+    void fit(const QSizeF& world);
+
+    /* look at the point, without changing the zoom */
+    void lookAt(const QVector2D& centre) { m_centre = centre; }
+
+    /**
+     * @brief pan - move the view along with a drag
+     * @param screenDelta - how far the drag moved, in window coordinates
+     */
+    void pan(const QPointF& screenDelta);
+
+    /**
+     * @brief zoomAt - zoom in (factor > 1) or out, keeping the point under the mouse where it is
+     * @param screen - the mouse, in window coordinates
+     * @param factor - how much to zoom by, the result is clamped to [MinZoom, MaxZoom]
+     */
+    void zoomAt(const QPointF& screen, double factor);
+
+    /* the point in table coordinates, of a point in window coordinates */
+    QVector2D toWorld(const QPointF& screen) const;
+    /* the part of the table under a part of the window */
+    QRectF toWorld(const QRectF& screen) const;
+
+    /* the part of the table that's in the window */
+    QRectF visible() const;
+
+    /**
+     * @brief apply - transform the painter, so the game can draw in table coordinates
+     */
+    void apply(QPainter& painter) const;
+
+    double zoom() const { return m_zoom; }
+
+private:
+    // the table point in the middle of the window
+    QVector2D m_centre;
+    double m_zoom = 1.0;
+    QSizeF m_viewport;
+};
@@ -0,0 +1,53 @@
+#include "contactcache.h"
+#include <algorithm>
+
+void ContactCache::update(const std::vector<Ball *> &balls, Real width, Real height) {
+    if (m_valid && holds(balls)) return;
+    rebuild(balls, width, height);
+}
+
+bool ContactCache::holds(const std::vector<Ball *> &balls) const {
+    if (balls.size() != m_anchors.size()) return false;
+    const Real drift = ContactCache::drift();
+    for (size_t i = 0; i < balls.size(); ++i) {
+        // it doesn't matter if it's the same ball, only that it's the same size and still close to where it was
+        if (balls[i]->getRadius() != m_radii[i]) return false;
+        if ((balls[i]->position() - m_anchors[i]).lengthSquared() > drift * drift) return false;
+    }
+    return true;
+}
+
+void ContactCache::around(const Vector &centre, Real reach, std::vector<unsigned> &out) const {
+    // every ball is within the drift of where the grid has it
+    reach += drift();
+    m_grid.within(centre - Vector(reach, reach), centre + Vector(reach, reach), out);
+}
+
+void ContactCache::rebuild(const std::vector<Ball *> &balls, Real width, Real height) {
+    m_grid.reset(width, height, CellSize);
+    m_anchors.clear();
+    m_radii.clear();
+    for (const Ball* b : balls) {
+        m_grid.add(b->position(), b->getRadius());
+        m_anchors.push_back(b->position());
+        m_radii.push_back(b->getRadius());
+    }
+
+    m_first.clear();
+    m_pairs.clear();
+    for (size_t i = 0; i < balls.size(); ++i) {
+        m_first.push_back(unsigned(m_pairs.size()));
+        const Vector& centre = m_anchors[i];
+        const Real reach = m_radii[i] + Skin;
+        // comes back sorted, so the pairs are in the order the step would have checked them
+        m_grid.within(centre - Vector(reach, reach), centre + Vector(reach, reach), m_candidates);
+        for (unsigned j : m_candidates) {
+            if (j <= i) continue;
+            const Real apart = reach + m_radii[j];
+            if ((m_anchors[j] - centre).lengthSquared() <= apart * apart) m_pairs.push_back(j);
+        }
+    }
+    m_first.push_back(unsigned(m_pairs.size()));
+    m_valid = true;
+    ++m_rebuilds;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include "ball.h"
+#include "occlusion.h"
+#include "physics.h"
+
+/**
+ * @brief The ContactCache class
+ * The pairs of balls that are close enough to touch, kept from one step to the next. Every pair is found with
+ *  some room to spare (Skin), so as long as no ball has moved more than half of that since, no other pair can
+ *  be touching yet and the same pairs are checked again. Racked or resting balls barely move, so the pairs are
+ *  only found again (in linear time, with a CircleGrid) once things get going, rather than testing every pair
+ *  of balls every step.
+ *
+ * Pairs are by index into the game's balls, later balls only, in order. The step checks exactly the pairs it
+ *  would have otherwise, so nothing about the physics changes.
+ */
+class ContactCache {
+public:
+    /* the later balls that a ball might touch, in order */
+    struct Range {
+        const unsigned* first;
+        const unsigned* last;
+        const unsigned* begin() const { return first; }
+        const unsigned* end() const { return last; }
+    };
+
+    /**
+     * @brief update - get ready for a step, finding the pairs again if any ball has moved too far since they were found
+     * @param balls - the balls, as they are before the step (none are nullptr)
+     * @param width - the table's width
+     * @param height - the table's height
+     */
+    void update(const std::vector<Ball*>& balls, Real width, Real height);
+
+    /**
+     * @brief near - the later balls that the ball might touch this step
+     * @param ball - the ball's index
+     */
+    Range near(size_t ball) const {
+        const unsigned* pairs = m_pairs.data();
+        return Range{pairs + m_first[ball], pairs + m_first[ball + 1]};
+    }
+
+    /**
+     * @brief around - the balls that might be within reach of a point, from the grid the pairs were found with.
+     *  Only as good as the step's update, so balls that have moved since the step began need more reach
+     * @param centre - the point
+     * @param reach - how far from the point, not counting the balls' own radii
+     * @param out - cleared, then filled with the balls' indices, in order
+     */
+    void around(const Vector& centre, Real reach, std::vector<unsigned>& out) const;
+
+    /* a ball jumped somewhere else mid step, so find the pairs again next step */
+    void invalidate() { m_valid = false; }
+
+    /* how many times the pairs have been found */
+    size_t rebuilds() const { return m_rebuilds; }
+
+private:
+    // how much further apart than touching a pair can be, and still be kept
+    static constexpr Real Skin = 8;
+    // the cells of the grid the pairs are found with
+    static constexpr Real CellSize = 64;
+    // how far a ball can be from where the pairs were found, and they still hold.
+    //  a little under half the skin, so rounding can never let a pair slip through
+    static Real drift() { return Skin * Real(0.45); }
+
+    bool m_valid = false;
+    size_t m_rebuilds = 0;
+    // where every ball was (and how large) when the pairs were found
+    std::vector<Vector> m_anchors;
+    std::vector<int> m_radii;
+    // the pairs of every ball, i.e. ball i's later balls are m_pairs[m_first[i] .. m_first[i + 1])
+    std::vector<unsigned> m_first;
+    std::vector<unsigned> m_pairs;
+    // scratch space for finding them
+    CircleGrid m_grid;
+    std::vector<unsigned> m_candidates;
+
+    /* whether the pairs still hold for the balls */
+    bool holds(const std::vector<Ball*>& balls) const;
+    /* find the pairs again */
+    void rebuild(const std::vector<Ball*>& balls, Real width, Real height);
+};
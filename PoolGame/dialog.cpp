@@ -2,21 +2,22 @@
 #include "ui_dialog.h"
 #include <QPainter>
 #include <QTimer>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWindow>
+#include <QElapsedTimer>
+#include <cmath>
 #include <iostream>
 #include <QMouseEvent>
+#include <algorithm>
 #include "utils.h"
+#include "scenariocache.h"
 
-Dialog::Dialog(Game *game, QWidget* parent) :
+Dialog::Dialog(Game *game, QWidget* parent, const std::vector<Game*>& history) :
     QDialog(parent),
-    ui(new Ui::Dialog),
-    m_game(game)
+    ui(new Ui::Dialog)
 {
-    if(m_game->isStageThree()){
-        //initialise the originator when the game is in stageThree
-        m_orig = new Originator(game);
-    }else{
-        m_orig = NULL;
-    }
+    resume(game, history);
     ui->setupUi(this);
 
     // for animating (i.e. movement, collision) every animFrameMS
@@ -27,23 +28,99 @@ Dialog::Dialog(Game *game, QWidget* parent) :
     // for drawing every drawFrameMS milliseconds
     dTimer = new QTimer(this);
     connect(dTimer, SIGNAL(timeout()), this, SLOT(tryRender()));
-    dTimer->start(drawFrameMS);
+    paceRender();
+    dTimer->start();
 
-    // set the window size to be at least the table size
-    this->resize(game->getMinimumWidth(), game->getMinimumHeight());
+    // set the window size to be the table size, as long as that fits on the screen. the camera shows the rest
+    int width = game->getMinimumWidth(), height = game->getMinimumHeight();
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        width = std::min(width, screen->availableSize().width());
+        height = std::min(height, screen->availableSize().height());
+    }
+    this->resize(width, height);
+    m_camera.setViewport(QSizeF(width, height));
+    m_camera.lookAt(QVector2D(game->getMinimumWidth() / 2.0, game->getMinimumHeight() / 2.0));
 }
 
 
 void Dialog::restore(){
     if(m_memos.size() > 0){
+        Memento* memo = m_memos.back();//get the most recently saved game
+        m_memos.pop_back();//remove that game from the stack
+        // waits for the memento's game, if it's still being built. it can't always be rebuilt, so keep playing this one
+        if (m_orig->peek(memo) == nullptr) {
+            std::cerr << "couldn't restore the game from before the last shot\n";
+            delete memo;
+            return;
+        }
         delete m_game;
-        Memento* memo = m_memos.top();//get the most recently saved game
-        m_memos.pop();//remove that game from the stack
         m_orig->restore(memo);
         m_game = m_orig->getGame();
+        m_game->setQuality(m_governor.quality());
+        delete memo;
+        // the restored game can't be re-simulated, so the timeline starts again from it
+        m_timeline.reset(m_step, *m_game);
     }
 }
 
+void Dialog::replace(Game *game) {
+    delete m_game;
+    m_game = game;
+    m_game->setQuality(m_governor.quality());
+    if (m_orig != nullptr) m_orig->setGame(game);
+}
+
+void Dialog::scrub(long steps) {
+    size_t target = steps < 0 ? m_step - std::min<size_t>(m_step, -steps) : m_step + steps;
+    // the oldest history is forgotten in long sessions, so that's as far back as it goes
+    target = std::max(std::min(target, m_timeline.end()), m_timeline.begin());
+    Game* game = m_timeline.seek(target, 1.0/(double)animFrameMS);
+    if (game == nullptr) return;
+    replace(game);
+    m_step = target;
+}
+
+void Dialog::resume(Game *game, const std::vector<Game *> &history) {
+    if (m_orig != nullptr) {
+        for (Memento* memo : m_memos) m_orig->discard(memo);
+        m_memos.clear();
+        delete m_orig;
+    }
+    m_game = game;
+    m_game->setQuality(m_governor.quality());
+    if(m_game->isStageThree()){
+        //initialise the originator when the game is in stageThree
+        m_orig = new Originator(game);
+        for (Game* saved : history) m_memos.push_back(m_orig->createMomento(saved));
+    }else{
+        m_orig = NULL;
+    }
+    for (Game* saved : history) delete saved;
+    // a different session, so a different timeline
+    m_step = 0;
+    m_timeline = Timeline();
+    m_timeline.reset(m_step, *m_game);
+}
+
+void Dialog::saveCheckpoint() {
+    std::vector<Game*> history;
+    for (Memento* memo : m_memos) {
+        // a shot whose game couldn't be rebuilt can't be restored either, so there's nothing to save
+        if (Game* saved = m_orig->peek(memo)) history.push_back(saved);
+    }
+    if (ScenarioCache::saveCheckpoint(checkpoint_path, *m_game, history)) {
+        std::cout << "saved checkpoint to " << checkpoint_path << std::endl;
+    }
+}
+
+void Dialog::loadCheckpoint() {
+    std::vector<Game*> history;
+    Game* game = ScenarioCache::loadCheckpoint(checkpoint_path, history);
+    if (game == nullptr) return;
+    delete m_game;
+    resume(game, history);
+}
+
 Dialog::~Dialog()
 {
     delete aTimer;
@@ -54,58 +131,199 @@ Dialog::~Dialog()
 
 void Dialog::tryRender() {
     this->update();
+    // nothing is moving, so that was the last frame worth drawing until some input wakes us up
+    if (!aTimer->isActive()) dTimer->stop();
 }
 
-void Dialog::nextAnim() {
+void Dialog::wake() {
+    if (!m_paused && !aTimer->isActive()) aTimer->start(animFrameMS);
+    if (!dTimer->isActive()) dTimer->start();
+    this->update();
+}
+
+void Dialog::paceRender() {
+    int interval = drawFrameMS;
+    if (m_vsync) {
+        QScreen* screen = windowHandle() != nullptr ? windowHandle()->screen() : QGuiApplication::primaryScreen();
+        if (screen != nullptr && screen->refreshRate() > 0) interval = std::max(1, int(std::lround(1000.0 / screen->refreshRate())));
+    }
+    // a coarse timer can be off by 5%, which beats against the refresh rate
+    dTimer->setTimerType(m_vsync ? Qt::PreciseTimer : Qt::CoarseTimer);
+    dTimer->setInterval(interval * m_governor.quality().renderInterval);
+}
+
+void Dialog::step() {
+    // we're somewhere we've been before, so do what the player did then
+    if (m_step < m_timeline.end()) m_timeline.replay(m_step, *m_game);
     m_game->animate(1.0/(double)animFrameMS);
+    m_timeline.stepped(++m_step, *m_game);
     if(m_game->toSave()){
-        m_memos.push(m_orig->createMomento());
+        m_memos.push_back(m_orig->createMomento());
         m_game->notSave();
     }
 }
 
+void Dialog::turbo() {
+    // every step still goes through the timeline, so the shot can be scrubbed through afterwards.
+    //  it all happens on the GUI thread, so it gives up after a while (pressing F again carries on)
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t i = 0; i < TurboSteps && m_game->shotInProgress() && timer.elapsed() < TurboMS; ++i) step();
+    this->update();
+}
+
+void Dialog::nextAnim() {
+    QElapsedTimer timer;
+    timer.start();
+    step();
+    m_governor.stepped(timer.nsecsElapsed());
+    // stop stepping a table where nothing happens, unless there are inputs left to replay.
+    // quiet steps aren't counted either, so the timeline stays the same
+    if (m_game->isQuiescent() && m_step >= m_timeline.end()) aTimer->stop();
+}
+
 void Dialog::paintEvent(QPaintEvent *)
 {
     QPainter painter(this);
-    m_game->render(painter);
+    QElapsedTimer timer;
+    timer.start();
+    if (m_tiled) {
+        // drawn offscreen in parallel, then copied to the window in one go
+        painter.drawImage(0, 0, m_renderer.render(*m_game, m_camera, this->size()));
+    } else {
+        // the game draws in table coordinates, and only what the camera can see
+        painter.save();
+        m_camera.apply(painter);
+        m_game->render(painter, m_camera.visible());
+        painter.restore();
+    }
+    // too slow (or fast enough again), so change how much effort the next frames get
+    if (m_governor.painted(timer.nsecsElapsed())) {
+        m_game->setQuality(m_governor.quality());
+        paceRender();
+    }
+    if (m_showGovernor) {
+        m_governor.render(painter);
+        const ShotSummary& s = m_game->lastShot();
+        if (s.shot > 0) {
+            painter.drawText(10, 52, QString("shot %1: %2s, %3 collisions, %4 wall hits, %5 breaks, %6 sunk, %7 left")
+                             .arg(int(s.shot)).arg(s.duration, 0, 'f', 1).arg(int(s.collisions)).arg(int(s.wallHits))
+                             .arg(int(s.breaks)).arg(int(s.sunk)).arg(int(s.ballsLeft)));
+        }
+    }
 }
 
 void Dialog::mousePressEvent(QMouseEvent* event) {
+    // the right (or middle) button drags the camera around instead
+    if (event->button() == Qt::RightButton || event->button() == Qt::MiddleButton) {
+        m_panning = true;
+        m_panFrom = event->localPos();
+        return;
+    }
+    wake();
     evalAllEventsOfTypeSpecified(MouseEventable::EVENTS::MouseClickFn, event);
 }
 
 void Dialog::mouseReleaseEvent(QMouseEvent* event) {
+    if (m_panning && (event->button() == Qt::RightButton || event->button() == Qt::MiddleButton)) {
+        m_panning = false;
+        return;
+    }
+    wake();
+    CueBall* cue = m_game->findCue();
+    const QVector2D before = cue ? cue->ball()->getVelocity() : QVector2D();
     evalAllEventsOfTypeSpecified(MouseEventable::EVENTS::MouseRelFn, event);
+    // log the shot, so the timeline can take it again
+    if (cue != nullptr && cue->ball()->getVelocity() != before) {
+        m_timeline.record(Timeline::Input{m_step, Timeline::Input::CueShot,
+                                          cue->savedPosition(), cue->ball()->getVelocity(), 0});
+    }
 }
 void Dialog::mouseMoveEvent(QMouseEvent* event) {
+    if (m_panning) {
+        m_camera.pan(event->localPos() - m_panFrom);
+        m_panFrom = event->localPos();
+        this->update();
+        return;
+    }
+    // only a drag changes anything
+    if (event->buttons() != Qt::NoButton) wake();
     evalAllEventsOfTypeSpecified(MouseEventable::EVENTS::MouseMoveFn, event);
 }
 
+void Dialog::wheelEvent(QWheelEvent* event) {
+    // a notch is 120
+    m_camera.zoomAt(event->posF(), std::pow(ZoomStep, event->angleDelta().y() / 120.0));
+    this->update();
+}
+
+void Dialog::resizeEvent(QResizeEvent*) {
+    m_camera.setViewport(QSizeF(this->size()));
+}
+
 void Dialog::keyPressEvent(QKeyEvent * event){
+    // whatever the key does, it's drawn (and simulated) from here
+    wake();
+    if(event->key() == Qt::Key_F5){
+        saveCheckpoint(); // save everything when pressed F5
+        return;
+    }else if(event->key() == Qt::Key_F9){
+        loadCheckpoint(); // and load it back when pressed F9
+        return;
+    }else if(event->key() == Qt::Key_Left || event->key() == Qt::Key_Right){
+        scrub(event->key() == Qt::Key_Left ? -ScrubSteps : ScrubSteps); // scrub through the timeline with the arrows
+        return;
+    }else if(event->key() == Qt::Key_Comma || event->key() == Qt::Key_Period){
+        scrub(event->key() == Qt::Key_Comma ? -1 : 1); // a single step with < and >
+        return;
+    }else if(event->key() == Qt::Key_Space){
+        // pause/play
+        m_paused = !m_paused;
+        if (m_paused) aTimer->stop();
+        else wake();
+        return;
+    }else if(event->key() == Qt::Key_Home){
+        m_camera.fit(QSizeF(m_game->getMinimumWidth(), m_game->getMinimumHeight())); // show the whole table
+        return;
+    }else if(event->key() == Qt::Key_F){
+        turbo(); // fast forward to the end of the shot
+        return;
+    }else if(event->key() == Qt::Key_T){
+        m_tiled = !m_tiled; // draw in tiles on every core (or not)
+        return;
+    }else if(event->key() == Qt::Key_F3){
+        m_showGovernor = !m_showGovernor; // show/hide the quality tier & frame timings
+        return;
+    }else if(event->key() == Qt::Key_V){
+        // draw in step with the screen's refresh (or not)
+        m_vsync = !m_vsync;
+        paceRender();
+        return;
+    }
     //only works in stage3
     if(m_game->isStageThree()){
         if(event->key() == Qt::Key_R){
             restore(); // restore the game when pressed R
         }else if(event->key() == Qt::Key_S){
+            m_timeline.record(Timeline::Input{m_step, Timeline::Input::SwitchMode, QVector2D(), QVector2D(), 0});
             m_game->switchMode(); //swtich the strategy when pressed S
         }else if(event->key() == Qt::Key_A){
+            m_timeline.record(Timeline::Input{m_step, Timeline::Input::AddBall, QVector2D(), QVector2D(), 1});
             m_game->addRandomBall(); //add ball when pressed A
+        }else if(event->key() == Qt::Key_B){
+            m_timeline.record(Timeline::Input{m_step, Timeline::Input::AddBall, QVector2D(), QVector2D(), bulkSpawnCount});
+            m_game->addRandomBalls(bulkSpawnCount); //add a whole bunch of balls when pressed B
         }
     }
 }
 
 
 void Dialog::evalAllEventsOfTypeSpecified(MouseEventable::EVENTS t, QMouseEvent *event) {
-    // handle all the clicky events, and remove them if they've xPIRED
-    MouseEventable::EventQueue& Qu = m_game->getEventFns();
-    for (ssize_t i = Qu.size()-1; i >= 0; i--) {
-        if (auto spt = (Qu.at(i)).lock()) {
-            if (spt->second == t) {
-                spt->first(event);
-            }
-        } else {
-            // remove this element from our vector
-            Qu.erase(Qu.begin() + i);
-        }
+    // the handlers only know table coordinates
+    QMouseEvent mapped(event->type(), m_camera.toWorld(event->localPos()).toPointF(),
+                       event->button(), event->buttons(), event->modifiers());
+    // handle all the clicky events, only the ones listening for this type are in here
+    for (MouseEventable* handler : m_game->getEventFns(t)) {
+        handler->dispatch(t, &mapped);
     }
 }
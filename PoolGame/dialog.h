@@ -1,9 +1,13 @@
 #pragma once
 #include <QDialog>
-#include <stack>
+#include <vector>
 #include "ball.h"
 #include "game.h"
 #include "originator.h"
+#include "timeline.h"
+#include "governor.h"
+#include "camera.h"
+#include "tilerenderer.h"
 
 namespace Ui {
 class Dialog;
@@ -14,7 +18,11 @@ class Dialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit Dialog(Game* game, QWidget *parent = 0);
+    /**
+     * @param game - the game to play
+     * @param history - saved games that undo can go back to, oldest first (i.e. from a checkpoint). taken ownership of
+     */
+    explicit Dialog(Game* game, QWidget *parent = 0, const std::vector<Game*>& history = std::vector<Game*>());
     ~Dialog();
 
 protected:
@@ -40,10 +48,14 @@ public slots:
     void mouseMoveEvent(QMouseEvent* event);
     // qt key pressed
     void keyPressEvent(QKeyEvent * event);
+    // qt mouse wheel, zooms
+    void wheelEvent(QWheelEvent* event);
+    // qt window resized
+    void resizeEvent(QResizeEvent* event);
 private:
     /**
-     * @brief evalAllEventsOfTypeSpecified - for each of the functions in the event queue
-     *  invoke them if the event type is equal
+     * @brief evalAllEventsOfTypeSpecified - for each of the handlers listening
+     *  for the event type, invoke them
      * @param t - the event type
      * @param event - the event to forward on to the function
      */
@@ -52,7 +64,55 @@ private:
      * @brief restore - restore the game back before the last shoot
      */
     void restore();
+    /**
+     * @brief saveCheckpoint - write the game and its undo history to checkpoint_path
+     */
+    void saveCheckpoint();
+    /**
+     * @brief loadCheckpoint - replace the game and its undo history with checkpoint_path's
+     */
+    void loadCheckpoint();
+    /**
+     * @brief resume - play the game, with the given undo history
+     * @param game - the game to play
+     * @param history - saved games, oldest first. they are cloned into mementos, then deleted
+     */
+    void resume(Game* game, const std::vector<Game*>& history);
+    /**
+     * @brief scrub - move through the timeline, i.e. back to watch the last shot again
+     * @param steps - how many steps to move by (negative is backwards)
+     */
+    void scrub(long steps);
+    /**
+     * @brief replace - swap the game being played for another
+     */
+    void replace(Game* game);
+    /**
+     * @brief step - simulate a single step, replaying and keeping the timeline & undo stack up to date
+     */
+    void step();
+    /**
+     * @brief turbo - simulate the rest of the shot without drawing any of it, then show where it ended up
+     */
+    void turbo();
+    /**
+     * @brief wake - start the timers again after the game went quiet, called on any input
+     */
+    void wake();
+    /**
+     * @brief paceRender - set the render timer's interval, to the screen's refresh rate when pacing to vsync.
+     *  slowed down further when the governor says so
+     */
+    void paceRender();
 private:
+    // how many steps the arrow keys scrub by
+    static constexpr long ScrubSteps = 100;
+    // how much a notch of the mouse wheel zooms by
+    static constexpr double ZoomStep = 1.15;
+    // most steps turbo takes, in case the shot never settles (6000 simulated seconds, at 0.1s a step)
+    static constexpr size_t TurboSteps = 60000;
+    // most time turbo takes before showing where it got to, in ms
+    static constexpr qint64 TurboMS = 250;
     /**
      * @brief aTimer - timer for calling nextAnim in intervals
      */
@@ -74,8 +134,49 @@ private:
      */
     Originator* m_orig = nullptr;
     /**
-     * @brief m_memos - a list of Mementos
+     * @brief m_memos - a stack of Mementos, the most recent at the back
+     */
+    std::vector<Memento*> m_memos;
+    /**
+     * @brief m_timeline - keyframes & inputs, for scrubbing through the session
+     */
+    Timeline m_timeline;
+    /**
+     * @brief m_step - how many steps have been simulated
+     */
+    size_t m_step = 0;
+    /**
+     * @brief m_paused - whether the player paused the simulation, it isn't woken up by input then
+     */
+    bool m_paused = false;
+    /**
+     * @brief m_vsync - whether frames are drawn at the screen's refresh rate, rather than every drawFrameMS
+     */
+    bool m_vsync = false;
+    /**
+     * @brief m_governor - turns the drawing quality down when frames take too long, and back up
+     */
+    QualityGovernor m_governor;
+    /**
+     * @brief m_showGovernor - whether the governor's tier & timings are drawn over the game
+     */
+    bool m_showGovernor = false;
+    /**
+     * @brief m_camera - the part of the table being shown, the game only ever sees table coordinates
+     */
+    Camera m_camera;
+    /**
+     * @brief m_panFrom - where the last right (or middle) button drag event was, while panning
+     */
+    QPointF m_panFrom;
+    bool m_panning = false;
+    /**
+     * @brief m_renderer - draws the game offscreen, a tile per thread
+     */
+    TileRenderer m_renderer;
+    /**
+     * @brief m_tiled - whether frames are drawn by m_renderer, rather than straight to the window
      */
-    std::stack<Memento*> m_memos;
+    bool m_tiled = false;
 };
 
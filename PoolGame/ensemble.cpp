@@ -0,0 +1,135 @@
+#include "ensemble.h"
+#include <QJsonArray>
+#include <QtConcurrent>
+#include <functional>
+
+std::vector<EnsembleRun> Ensemble::parseRuns(const QJsonObject &sweep) {
+    std::vector<EnsembleRun> runs;
+    QJsonArray runData = sweep.value("runs").toArray();
+    if (runData.isEmpty()) runData.append(QJsonObject());
+    const int repeat = std::max(1, sweep.value("repeat").toInt(1));
+
+    for (int i = 0; i < runData.size(); ++i) {
+        QJsonObject r = runData.at(i).toObject();
+        EnsembleRun run;
+        run.seed = (unsigned) r.value("seed").toDouble(i * repeat);
+        run.friction = r.value("friction").toDouble(-1);
+        run.massScale = r.value("massScale").toDouble(1.0);
+        run.strengthScale = r.value("strengthScale").toDouble(1.0);
+        if (r.contains("cueVelocity")) {
+            QJsonObject v = r.value("cueVelocity").toObject();
+            run.hasCueVelocity = true;
+            run.cueVelocity = QVector2D(v.value("x").toDouble(), v.value("y").toDouble());
+        }
+        if (run.massScale <= 0 || run.strengthScale <= 0) {
+            std::cerr << "run " << i << " has a non-positive scale, ignoring it" << std::endl;
+            continue;
+        }
+        for (int k = 0; k < repeat; ++k) {
+            runs.push_back(run);
+            ++run.seed;
+        }
+    }
+    return runs;
+}
+
+std::vector<EnsembleOutcome> Ensemble::run(const std::vector<EnsembleRun> &runs) const {
+    // clones don't keep the cue's velocity (they're reset for undo), so remember it
+    CueBall* protoCue = m_prototype->findCue();
+    const QVector2D cuePos = protoCue ? protoCue->ball()->getPosition() : QVector2D();
+    const QVector2D cueVel = protoCue ? protoCue->ball()->getVelocity() : QVector2D();
+
+    // clone every game up front, so the workers never touch the prototype
+    QList<QPair<EnsembleRun, Game*>> jobs;
+    for (const EnsembleRun& r : runs) {
+        Game* game = m_prototype->clone();
+        game->seed(r.seed);
+        if (r.friction >= 0) game->getTable()->setFriction(r.friction);
+        if (r.massScale != 1.0 || r.strengthScale != 1.0) {
+            for (Ball* b : game->getBalls()) b->scale(r.massScale, r.strengthScale);
+        }
+        if (CueBall* cue = game->findCue()) {
+            cue->ball()->setPosition(cuePos);
+            cue->ball()->setVelocity(r.hasCueVelocity ? r.cueVelocity : cueVel);
+        }
+        jobs.append(qMakePair(r, game));
+    }
+
+    std::function<EnsembleOutcome(const QPair<EnsembleRun, Game*>&)> play =
+            [this](const QPair<EnsembleRun, Game*>& job) { return simulate(job.first, job.second); };
+    QVector<EnsembleOutcome> outcomes = QtConcurrent::blockingMapped<QVector<EnsembleOutcome>>(jobs, play);
+    return std::vector<EnsembleOutcome>(outcomes.begin(), outcomes.end());
+}
+
+EnsembleOutcome Ensemble::simulate(const EnsembleRun &run, Game *game) const {
+    EnsembleOutcome outcome;
+    outcome.run = run;
+    const size_t maxSteps = (size_t) std::ceil(m_maxTime / m_dt);
+    while (!(outcome.settled = game->isSettled()) && outcome.steps < maxSteps) {
+        game->animate(m_dt);
+        ++outcome.steps;
+    }
+    outcome.settleTime = outcome.steps * m_dt;
+    outcome.breaks = game->getBreaks();
+    outcome.remaining = game->getBalls().size();
+    outcome.sunk = game->getSunkCounts();
+    delete game;
+    return outcome;
+}
+
+QJsonObject Ensemble::report(const std::vector<EnsembleOutcome> &outcomes) {
+    QJsonArray runs;
+    std::vector<size_t> sunkTotals;
+    size_t settled = 0, breaks = 0;
+    double settleTime = 0;
+
+    for (const EnsembleOutcome& o : outcomes) {
+        QJsonObject r;
+        r["seed"] = (double) o.run.seed;
+        if (o.run.friction >= 0) r["friction"] = o.run.friction;
+        r["massScale"] = o.run.massScale;
+        r["strengthScale"] = o.run.strengthScale;
+        if (o.run.hasCueVelocity) {
+            r["cueVelocity"] = QJsonObject({{"x", o.run.cueVelocity.x()}, {"y", o.run.cueVelocity.y()}});
+        }
+        r["settled"] = o.settled;
+        r["settleTime"] = o.settleTime;
+        r["steps"] = (double) o.steps;
+        r["breaks"] = (double) o.breaks;
+        r["remaining"] = (double) o.remaining;
+        QJsonArray sunk;
+        for (size_t i = 0; i < o.sunk.size(); ++i) {
+            sunk.append((double) o.sunk[i]);
+            if (sunkTotals.size() <= i) sunkTotals.resize(i + 1, 0);
+            sunkTotals[i] += o.sunk[i];
+        }
+        r["sunk"] = sunk;
+        runs.append(r);
+
+        breaks += o.breaks;
+        // only count the ones that actually settled, the rest just hit the limit
+        if (o.settled) {
+            ++settled;
+            settleTime += o.settleTime;
+        }
+    }
+
+    const double n = std::max<size_t>(1, outcomes.size());
+    QJsonArray totals, means;
+    for (size_t s : sunkTotals) {
+        totals.append((double) s);
+        means.append(s / n);
+    }
+    QJsonObject summary;
+    summary["runs"] = (double) outcomes.size();
+    summary["settled"] = (double) settled;
+    summary["meanSettleTime"] = settled ? settleTime / settled : 0.0;
+    summary["meanBreaks"] = breaks / n;
+    summary["sunk"] = totals;
+    summary["meanSunk"] = means;
+
+    QJsonObject report;
+    report["runs"] = runs;
+    report["summary"] = summary;
+    return report;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "game.h"
+#include <QJsonObject>
+#include <QVector2D>
+#include <vector>
+
+/**
+ * @brief The EnsembleRun struct
+ * The overrides for one game of an ensemble, everything else is the same as the config
+ */
+struct EnsembleRun {
+    unsigned seed = 0;
+    // the table's friction, negative to keep the config's
+    double friction = -1;
+    // multipliers for the mass & strength of every ball (nested balls included)
+    double massScale = 1.0;
+    double strengthScale = 1.0;
+    // the cue ball's velocity, if we want to change it
+    bool hasCueVelocity = false;
+    QVector2D cueVelocity;
+};
+
+/**
+ * @brief The EnsembleOutcome struct
+ * How one game of an ensemble played out
+ */
+struct EnsembleOutcome {
+    EnsembleRun run;
+    bool settled = false;
+    // simulated seconds until every ball came to rest (or we gave up)
+    double settleTime = 0;
+    size_t steps = 0;
+    size_t breaks = 0;
+    // balls left on the table
+    size_t remaining = 0;
+    // how many balls each pocket sunk
+    std::vector<size_t> sunk;
+};
+
+/**
+ * @brief The Ensemble class
+ * Plays many independent copies of a game, each with its own overrides, until they settle.
+ *  Every copy is a clone of the prototype with its own random source, so they're stepped
+ *  on the global thread pool without sharing anything that changes.
+ */
+class Ensemble {
+    // the game that every run is cloned from, not owned
+    Game* m_prototype;
+    // the timestep, and how long a run may take before we give up on it settling
+    double m_dt;
+    double m_maxTime;
+
+    /**
+     * @brief simulate - step the game until it settles
+     * @param run - the overrides that were applied to the game
+     * @param game - the game to play, taken ownership of
+     * @return how it went
+     */
+    EnsembleOutcome simulate(const EnsembleRun& run, Game* game) const;
+public:
+    Ensemble(Game* prototype, double dt = 1.0/(double)animFrameMS, double maxTime = 600.0) :
+        m_prototype(prototype), m_dt(dt), m_maxTime(maxTime) {}
+
+    /**
+     * @brief parseRuns - read the runs of a sweep, e.g.
+     *  {"repeat": 4, "runs": [{"seed": 1, "friction": 0.2, "massScale": 2, "strengthScale": 0.5, "cueVelocity": {"x": 300, "y": 0}}]}
+     *  every run is repeated with consecutive seeds
+     * @param sweep - the sweep's json
+     * @return the runs, or a single run without overrides if none were given
+     */
+    static std::vector<EnsembleRun> parseRuns(const QJsonObject& sweep);
+
+    /**
+     * @brief run - play all of the runs in parallel
+     * @param runs - the overrides of each game
+     * @return the outcomes, in the same order as the runs
+     */
+    std::vector<EnsembleOutcome> run(const std::vector<EnsembleRun>& runs) const;
+
+    /**
+     * @brief report - each outcome, along with totals & means over all of them
+     * @param outcomes - the outcomes of run
+     * @return the report
+     */
+    static QJsonObject report(const std::vector<EnsembleOutcome>& outcomes);
+};
@@ -0,0 +1,60 @@
+#include "eventstream.h"
+#include <algorithm>
+#include <cstring>
+
+EventStream::EventStream(size_t capacity) : m_head(0) {
+    size_t size = 1;
+    while (size < std::max<size_t>(capacity, 1)) size <<= 1;
+    m_slots = std::vector<Slot>(size);
+    for (Slot& s : m_slots) {
+        s.sequence.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& w : s.event) w.store(0, std::memory_order_relaxed);
+    }
+    m_mask = size - 1;
+}
+
+void EventStream::publish(const std::vector<PhysicsEvent> &events) {
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t words[EventWords] = {};
+    for (const PhysicsEvent& e : events) {
+        Slot& slot = m_slots[head & m_mask];
+        // mark the slot as being written before touching the event, so readers of the old one notice
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(words, &e, sizeof(PhysicsEvent));
+        for (size_t w = 0; w < EventWords; ++w) slot.event[w].store(words[w], std::memory_order_relaxed);
+        slot.sequence.store(head + 1, std::memory_order_release);
+        ++head;
+    }
+    m_head.store(head, std::memory_order_release);
+}
+
+size_t EventStream::Subscriber::poll(std::vector<PhysicsEvent> &out, size_t max) {
+    const uint64_t head = m_stream->m_head.load(std::memory_order_acquire);
+    // anything further back than the capacity is gone already
+    if (head - m_next > m_stream->m_slots.size()) {
+        m_dropped += head - m_stream->m_slots.size() - m_next;
+        m_next = head - m_stream->m_slots.size();
+    }
+    size_t taken = 0;
+    uint64_t words[EventWords];
+    for (; m_next < head && taken < max; ++m_next) {
+        const Slot& slot = m_stream->m_slots[m_next & m_stream->m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_next + 1) {
+            ++m_dropped;
+            continue;
+        }
+        for (size_t w = 0; w < EventWords; ++w) words[w] = slot.event[w].load(std::memory_order_relaxed);
+        // the copy only counts if the slot wasn't rewritten while we made it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != m_next + 1) {
+            ++m_dropped;
+            continue;
+        }
+        PhysicsEvent e;
+        memcpy(&e, words, sizeof(PhysicsEvent));
+        out.push_back(e);
+        ++taken;
+    }
+    return taken;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QVector2D>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief The PhysicsEvent struct
+ * Something that happened during a physics step. The game collects a step's events, and everything
+ *  that reacts to them (particles, screen shake, shot stats, and any subscribers) does so after the step
+ */
+struct PhysicsEvent {
+    enum Type { Collision, WallHit, Break, Sink, CueStrike, Teleport, TypeCount };
+
+    // a ball that the event happened to
+    struct Subject {
+        // BallBehaviour flags of the ball at the time
+        int behaviours;
+        // absolute position of the ball (where it came out, for a teleport)
+        QVector2D position;
+        // magnitude of the change in velocity (its new speed, for a strike or teleport)
+        double deltaV;
+    };
+
+    Type type;
+    Subject ball;
+    // the other ball of a collision, unused otherwise
+    Subject other;
+};
+
+/**
+ * @brief The EventStream class
+ * A ring buffer of events, written by the thread stepping the game and read by any number of subscribers,
+ *  on any threads, without locks. Every subscriber sees every event, as long as it keeps up: the writer never
+ *  waits, so a subscriber that falls more than capacity() events behind misses the oldest ones.
+ *
+ * Each slot has a sequence number that is cleared while it's being written, so a reader can tell whether
+ *  the event it copied out was overwritten underneath it (a seqlock). The event itself is kept as atomic words,
+ *  so a reader racing the writer only ever gets a torn copy (which it throws away), never undefined behaviour.
+ */
+class EventStream : public std::enable_shared_from_this<EventStream> {
+    static_assert(std::is_trivially_copyable<PhysicsEvent>::value, "events are copied a word at a time");
+    static constexpr size_t EventWords = (sizeof(PhysicsEvent) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        // the index of the event in the slot + 1, 0 while it's being written
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> event[EventWords];
+    };
+public:
+    /**
+     * @param capacity - how many events are kept for the subscribers, rounded up to a power of two
+     */
+    explicit EventStream(size_t capacity = DefaultCapacity);
+
+    /**
+     * @brief The Subscriber class
+     * Where one reader is up to in the stream. Keeps the stream alive, so it can outlive the game
+     */
+    class Subscriber {
+    public:
+        /**
+         * @brief poll - take the events published since the last poll
+         * @param out - the events are appended to this
+         * @param max - most events to take
+         * @return how many were taken
+         */
+        size_t poll(std::vector<PhysicsEvent>& out, size_t max = std::numeric_limits<size_t>::max());
+        /* how many events were overwritten before we got to them */
+        uint64_t dropped() const { return m_dropped; }
+    private:
+        friend class EventStream;
+        Subscriber(std::shared_ptr<const EventStream> stream, uint64_t next) : m_stream(stream), m_next(next) {}
+
+        std::shared_ptr<const EventStream> m_stream;
+        // the index of the next event to read
+        uint64_t m_next;
+        uint64_t m_dropped = 0;
+    };
+
+    /**
+     * @brief subscribe - start reading the stream, from the next event published
+     *  (the stream must be owned by a shared_ptr)
+     */
+    Subscriber subscribe() const { return Subscriber(shared_from_this(), m_head.load(std::memory_order_acquire)); }
+
+    /**
+     * @brief publish - add the events to the stream, only ever called by one thread
+     */
+    void publish(const std::vector<PhysicsEvent>& events);
+
+    /* how many events have ever been published */
+    uint64_t published() const { return m_head.load(std::memory_order_acquire); }
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    static constexpr size_t DefaultCapacity = 4096;
+
+    std::vector<Slot> m_slots;
+    // capacity() - 1, to wrap an index to its slot
+    uint64_t m_mask;
+    // the index of the next event to publish
+    std::atomic<uint64_t> m_head;
+};
@@ -1,5 +1,6 @@
 #include "game.h"
 #include "utils.h"
+#include "occlusion.h"
 
 #include <QJsonArray>
 #include <stdexcept>
@@ -7,22 +8,31 @@
 #include <exception>
 #include <iostream>
 
+constexpr int Game::MaxSubsteps;
+
 Game::~Game() {
     // cleanup ya boi
     for (auto b : *m_balls) delete b;
     delete m_balls;
     delete m_table;
+    delete m_cue;
 }
 
-Game::Game(Game &game): m_save(false){
+Game::Game(Game &game): m_save(false), m_effects(game.m_effects), m_rng(game.m_rng), m_breaks(game.m_breaks),
+    m_shot(game.m_shot), m_lastShot(game.m_lastShot), m_shooting(game.m_shooting){
+    m_localStepping = game.m_localStepping;
     m_table = game.m_table->clone();
     m_balls = new std::vector<Ball*>();
     m_stageThree = game.m_stageThree;
     for(int i = 0; i< game.m_balls->size(); i++){
-        m_balls->push_back(game.m_balls->at(i)->clone());
+        Ball* ball = game.m_balls->at(i)->clone();
+        // the cue behaviour gets cloned along with its ball
+        if(game.m_cue != nullptr && game.m_cue->ball() == game.m_balls->at(i)){
+            m_cue = game.m_cue->clone(ball);
+            addMouseFunctions(m_cue); //register the mouse events to the game
+        }
+        m_balls->push_back(ball);
     }
-    CueBall* cue = findCue();
-    addMouseFunctions(cue->getEvents()); //register the mouse events to the game
     m_strategy = game.m_strategy->clone(m_balls, getPockets());
 }
 
@@ -31,101 +41,189 @@ Game *Game::clone(){
     return game;
 }
 
-CueBall *Game::findCue(){
-    for (int i = 0; i < m_balls->size();i++) {
-        Ball* ball = m_balls->at(i);
+void Game::adoptCue(){
+    for (Ball* ball : *m_balls) {
         if(ball->isCue()){
-            CueBall* cue = static_cast<CueBall*> (ball);
-            return cue;
+            m_cue = new CueBall(ball);
+            addMouseFunctions(m_cue); //register the mouse events to the game
+            return;
         }
     }
-    return NULL;
 }
 
-void Game::addRandomBall()
+size_t Game::addRandomBalls(size_t count)
 {
-    CompositeBall* ball = generateBall(m_table->getWidth(), m_table->getHeight());
-
-    bool overlap = false;
-    //chekc no overlap with other balls
+    const int width = m_table->getWidth(), height = m_table->getHeight();
+    // everything the new balls can't overlap with: the other balls, and the pockets
+    CircleGrid obstacles(width, height, 2*MaxSpawnRadius);
+    // the balls that new ones can still be grown out from (nothing grows out of a pocket)
+    std::vector<size_t> frontier;
+    // however many are asked for, no more than fit on the table can be added (discs at least MinSpawnRadius big, that don't overlap)
+    const size_t room = size_t(std::max(width, 0)) * size_t(std::max(height, 0)) / (3*MinSpawnRadius*MinSpawnRadius);
+    frontier.reserve(m_balls->size() + std::min(count, room));
     for(Ball* other : *m_balls){
-        double distance = other->getPosition().distanceToPoint(ball->getPosition());
-        double min_dis = other->getRadius() + ball->getRadius();
-        if(min_dis > distance){
-            overlap = true;
-            break;
-        }
+        frontier.push_back(obstacles.add(other->position(), other->getRadius()));
     }
-    //check no overlap with pockets
-    for(Pocket* pocket : *getPockets()){
-        double distance = pocket->pos().distanceToPoint(ball->getPosition());
-        double min_dis = pocket->radius() + ball->getRadius();
-        if(min_dis > distance){
-            overlap = true;
-            break;
-        }
+    std::vector<Pocket*>* pockets = getPockets();
+    if(pockets != nullptr){
+        for(Pocket* pocket : *pockets) obstacles.add(Vector(pocket->pos()), pocket->radius());
     }
 
-    if(overlap){
-        delete ball;
-        addRandomBall();//try it again
-    }else{
-        int sub_ball_num = rand()%3; // number of childrean balls varies from 0 to 2
-        for(int i = 0; i < sub_ball_num; i++){
-            Ball* b = generateSubBall(ball->getRadius());
-            ball->addChild(decrateBall(b));
+    std::uniform_real_distribution<Real> unit(0, 1);
+    // darts are thrown anywhere on the table, until they start to miss (i.e. it's getting crowded)
+    bool crowded = false;
+    size_t placed = 0;
+    for(; placed < count; ++placed){
+        const int radius = randomInt(MaxSpawnRadius - MinSpawnRadius) + MinSpawnRadius;
+        const bool fits = width > 2*radius && height > 2*radius;
+        Vector position;
+        bool found = false;
+        for(int attempt = 0; fits && !crowded && !found && attempt < SpawnAttempts; ++attempt){
+            position = Vector(randomInt(width - 2*radius) + radius, randomInt(height - 2*radius) + radius);
+            found = !obstacles.overlaps(position, radius);
+        }
+        crowded = crowded || !found;
+
+        // after that, fill in the gaps right next to the balls already down (poisson-disk sampling, a la Bridson)
+        while(fits && !found && !frontier.empty()){
+            const size_t pick = randomInt(int(frontier.size()));
+            const size_t from = frontier[pick];
+            for(int attempt = 0; !found && attempt < SpawnAttempts; ++attempt){
+                const Real angle = unit(m_rng) * Real(2*M_PI);
+                const Real distance = obstacles.radius(from) + radius + unit(m_rng) * radius;
+                position = obstacles.centre(from) + Vector(std::cos(angle), std::sin(angle)) * distance;
+                found = position.x >= radius && position.x <= width - radius
+                        && position.y >= radius && position.y <= height - radius
+                        && !obstacles.overlaps(position, radius);
+            }
+            // nothing fits next to that one anymore
+            if(!found){
+                frontier[pick] = frontier.back();
+                frontier.pop_back();
+            }
+        }
+        if(!found) break; // the table is full
+
+        // stage one games (no pockets) only have plain balls, which never break
+        Ball* ball = generateBall(position, radius, pockets != nullptr);
+        CompositeBall* composite = dynamic_cast<CompositeBall*>(ball);
+        int sub_ball_num = composite != nullptr ? randomInt(3) : 0; // number of childrean balls varies from 0 to 2
+        if(sub_ball_num > 0){
+            // children only exist as a blueprint until the ball breaks
+            std::shared_ptr<BallBlueprint> blueprint = std::make_shared<BallBlueprint>();
+            for(int i = 0; i < sub_ball_num; i++){
+                BallNode b = generateSubBall(composite->getRadius());
+                b.behaviours = randomBehaviour();
+                blueprint->push_back(b);
+            }
+            composite->setChildren(blueprint);
         }
-        m_balls->push_back(decrateBall(ball));
+        ball->addBehaviours(randomBehaviour());
+        m_balls->push_back(ball);
+        frontier.push_back(obstacles.add(position, radius));
     }
+    if(placed < count){
+        std::cerr << "no room left on the table, only added " << placed << " of " << count << " balls\n";
+    }
+    return placed;
 }
 
-Ball* Game::decrateBall(Ball* ball){
-    int num = rand() % 3;
+int Game::randomBehaviour(){
+    int num = randomInt(3);
     if(num == 0){
-        ball = new BallSparkleDecorator(ball);//add sparkle
+        return SparkleBehaviour;//add sparkle
     }else if(num == 1){
-        ball = new BallSmashDecorator(ball);//add crumbs
+        return SmashBehaviour;//add crumbs
     }
     //when num == 2 no decoration :<
-    return ball;
+    return NoBehaviour;
 }
 
-CompositeBall* Game::generateBall(int max_x, int max_y){
-    QColor colour(rand()%255,rand()%255,rand()%255);
-    int radius = rand() % 20 + 10;
-    QVector2D position = QVector2D(rand()%(max_x - 2*radius) + radius, rand()%(max_y - 2* radius) + radius);
+Ball* Game::generateBall(const Vector& position, int radius, bool composite){
+    QColor colour(randomInt(255),randomInt(255),randomInt(255));
     QVector2D velocity = QVector2D();
-    double mass = rand()%4 + 1;
-    double strength = rand()% 50000 + 100;
-    return new CompositeBall(colour,position,velocity,mass,radius,strength);
+    double mass = randomInt(4) + 1;
+    if(!composite) return new StageOneBall(colour,position.toQVector2D(),velocity,mass,radius);
+    double strength = randomInt(50000) + 100;
+    return new CompositeBall(colour,position.toQVector2D(),velocity,mass,radius,strength);
 }
 
-CompositeBall* Game::generateSubBall(int radius){
-    QColor colour(rand()%255,rand()%255,rand()%255);
-    int b_radius = rand() % (radius - 5) + 5;
+BallNode Game::generateSubBall(int radius){
+    QColor colour(randomInt(255),randomInt(255),randomInt(255));
+    int b_radius = randomInt(radius - 5) + 5;
     int r_limit = radius - b_radius;
-    QVector2D position = QVector2D(rand()%(2*r_limit) - r_limit, rand() % (2*r_limit) - r_limit);
-    QVector2D velocity = QVector2D();
-    double mass = rand()%4 + 1;
+    QVector2D position = QVector2D(randomInt(2*r_limit) - r_limit, randomInt(2*r_limit) - r_limit);
+    double mass = randomInt(4) + 1;
 
-    double strength = rand()% 50000 + 100;
-    return new CompositeBall(colour,position,velocity,mass,b_radius,strength);
+    double strength = randomInt(50000) + 100;
+    return BallNode{colour, position, mass, b_radius, strength, -1, 1, NoBehaviour};
 }
 
-void Game::render(QPainter &painter) {
-    // table is rendered first, as its the lowest
-    m_table->render(painter, m_screenshake);
+void Game::render(QPainter &painter, const QRectF& view) {
+    prepareRender(view);
+    renderView(painter, view, m_visible);
+}
 
-    // then render all the balls
-    for (Ball* b : *m_balls){
-        b->render(painter, m_screenshake);
-    }
-    if(m_stageThree){
-        m_strategy->render(painter);
+void Game::prepareRender(const QRectF &view) {
+    for (Ball* b : *m_balls) b->setRenderChildren(m_quality.renderChildren);
+    // everything is drawn without a view, so there's no need to find what's in it
+    if (view.isNull()) return;
+    m_tiles.reset(m_table->getWidth(), m_table->getHeight(), TILESIZE);
+    for (Ball* b : *m_balls) m_tiles.add(b->position(), b->getRadius());
+}
+
+void Game::renderView(QPainter &painter, const QRectF &view, std::vector<unsigned> &visible) const {
+    painter.setRenderHint(QPainter::Antialiasing, m_quality.antialiasing);
+    for (int layer = 0; layer < LayerCount; ++layer) renderLayer(painter, RenderLayer(layer), view, visible);
+}
+
+void Game::renderLayer(QPainter &painter, RenderLayer layer, const QRectF &view, std::vector<unsigned> &visible) const {
+    switch (layer) {
+    case TableLayer:
+        // table is rendered first, as its the lowest
+        m_table->render(painter, m_screenshake, view);
+        break;
+    case BallLayer:
+        // then render all the balls (in sight)
+        if (view.isNull()) {
+            visible.resize(m_balls->size());
+            for (size_t i = 0; i < visible.size(); ++i) visible[i] = i;
+        } else {
+            // the screenshake moves everything, so move the view the other way instead
+            const Vector shake(m_screenshake);
+            m_tiles.within(Vector(view.left(), view.top()) - shake, Vector(view.right(), view.bottom()) - shake, visible);
+        }
+        for (unsigned i : visible){
+            m_balls->at(i)->render(painter, m_screenshake);
+        }
+        break;
+    case EffectLayer:
+        // and their behaviours
+        if (m_cue != nullptr) m_cue->render(painter);
+        m_effects.render(painter, m_screenshake, view, m_quality.particleCap);
+        break;
+    case AidLayer:
+        if(m_stageThree){
+            m_strategy->render(painter);
+        }
+        break;
+    default:
+        break;
     }
 }
 
 void Game::animate(double dt) {
+    if (m_cue != nullptr) {
+        m_cue->step();
+        if (m_cue->takeStrike()) emitEvent(PhysicsEvent::CueStrike, m_cue->ball(), m_cue->ball()->velocity());
+    }
+    // a shot starts as soon as anything moves (i.e. the cue was just hit)
+    if (!m_shooting && !isSettled()) {
+        const size_t shot = m_lastShot.shot + 1;
+        m_shot = ShotSummary();
+        m_shot.shot = shot;
+        m_shooting = true;
+    }
     if(m_stageThree){
         //check for saving game
         CueBall* cue = findCue();
@@ -134,87 +232,243 @@ void Game::animate(double dt) {
             m_save = true;
             cue->notSave();// once is enough
         }
-        m_strategy->update();
+        // the aid is only ever drawn, so it can lag a few steps behind when drawing is struggling
+        if(++m_aidSteps >= m_quality.aidInterval){
+            m_aidSteps = 0;
+            m_strategy->update();
+        }
     }
 
     // keep track of the removed balls (they're set to nullptr during loop)
-    // clean up afterwards
-    std::vector<Ball*> toBeRemoved;
-    // add these balls to the list after we finish
-    std::vector<Ball*> toBeAdded;
+    // clean up afterwards, and add the new balls to the list after we finish (both are empty between steps)
+    std::vector<Ball*>& toBeRemoved = m_removed;
+    std::vector<Ball*>& toBeAdded = m_added;
+
+    // the pairs of balls that could touch during this step
+    m_contacts.update(*m_balls, m_table->getWidth(), m_table->getHeight());
+    m_movedSquared = 0;
 
     // (test) collide the ball with each other ball exactly once
     // to achieve this, balls only check collisions with balls "after them"
     for (auto it = m_balls->begin(); it != m_balls->end(); ++it) {
-        Ball* ballA = *it;
-        if (ballA == nullptr) continue;
-        // correct ball velocity if colliding with table
-        QVector2D tableBallDeltaV = resolveCollision(m_table, ballA);
-        // test and resolve breakages with balls bouncing off table
-        if (ballA->applyBreak(tableBallDeltaV, toBeAdded)) {
-            // mark this ball to be deleted
-            toBeRemoved.push_back(ballA);
-            incrementShake();
-            // nullify this ball
-            *it = nullptr;
-
-            continue;
-        }
-
-        // check whether ball should be swallowed
-        if (m_table->sinks(ballA)) {
-            // defer swallowing until later (messes iterators otherwise)
-            toBeRemoved.push_back(ballA);
-            // nullify this ball
-            *it = nullptr;
-            continue;
-        }
+        if (*it == nullptr) continue;
+        const Vector start = (*it)->position();
+        // bounce off the table, and break or sink into it
+        const bool teleported = hitTable(*it);
+        if (*it == nullptr) continue;
 
-        // check collision with all later balls
-        for (auto nestedIt = it + 1; nestedIt != m_balls->end(); ++nestedIt) {
-            Ball* ballB = *nestedIt;
-            if (ballB == nullptr) continue;
-            if (isColliding(ballA, ballB)) {
-                // retrieve the changes in velocities for each ball and resolve collision
-                QVector2D ballADeltaV,ballBDeltaV;
-                std::tie(ballADeltaV, ballBDeltaV) = resolveCollision(ballA, ballB);
-
-                // add screenshake, remove ball, and add children to table vector if breaking
-                if (ballA->applyBreak(ballADeltaV, toBeAdded)) {
-                    toBeRemoved.push_back(ballA);
-                    incrementShake();
-                    // nullify this ball
-                    *it = nullptr;
-                    break;
-                }
-                // add screenshake, remove ball, and add children to table vector if breaking
-                if (ballB->applyBreak(ballBDeltaV, toBeAdded)) {
-                    toBeRemoved.push_back(ballB);
-                    incrementShake();
-                    // nullify this ball
-                    *nestedIt = nullptr;
-                    continue;
-                }
+        // check collision with the later balls close enough to touch
+        if (teleported) {
+            // we're nowhere near where the pairs were found, so that's every later ball
+            for (auto nestedIt = it + 1; nestedIt != m_balls->end(); ++nestedIt) {
+                if (*nestedIt != nullptr && collidePair(*it, *nestedIt)) break;
+            }
+        } else {
+            for (unsigned b : m_contacts.near(it - m_balls->begin())) {
+                Ball*& ballB = (*m_balls)[b];
+                if (ballB != nullptr && collidePair(*it, ballB)) break;
             }
         }
         // we marked this ball as deleted, so skip
         if (*it == nullptr) continue;
 
-        // move ball due to speed
-        ballA->translate(ballA->getVelocity() * dt);
-        // apply friction
-        ballA->changeVelocity(-ballA->getVelocity() * m_table->getFriction() * dt);
+        // move ball due to speed, and apply friction
+        advance(*it, dt);
+        // fast balls later on look for what they can reach on the contact grid, which doesn't know we moved
+        if (m_localStepping && *it != nullptr) {
+            m_movedSquared = std::max(m_movedSquared, ((*it)->position() - start).lengthSquared());
+        }
     }
 
     // clean up them trash-balls
     for (Ball* b : toBeRemoved) {
+        // the cue ball broke, so there's nothing left to control
+        if (m_cue != nullptr && m_cue->ball() == b) {
+            removeMouseFunctions(m_cue);
+            delete m_cue;
+            m_cue = nullptr;
+        }
         delete b;
         // delete all balls marked with nullptr
         m_balls->erase(std::find(m_balls->begin(), m_balls->end(), nullptr));
     }
     for (Ball* b: toBeAdded) m_balls->push_back(b);
+    toBeRemoved.clear();
+    toBeAdded.clear();
+
+    // let everyone react to the step
+    consumeEvents();
+    m_effects.update(*m_balls, m_rng);
 
     updateShake(dt);
+    trackShot(dt);
+}
+
+void Game::trackShot(double dt) {
+    if (!m_shooting) return;
+    ++m_shot.steps;
+    m_shot.duration += dt;
+    if (!isShotOver()) return;
+    m_shooting = false;
+    m_shot.ballsLeft = m_balls->size();
+    m_lastShot = m_shot;
+    if (m_shotListener) m_shotListener(m_lastShot);
+}
+
+size_t Game::finishShot(double dt, size_t maxSteps) {
+    size_t steps = 0;
+    while (shotInProgress() && steps < maxSteps) {
+        animate(dt);
+        ++steps;
+    }
+    return steps;
+}
+
+bool Game::hitTable(Ball *&slot) {
+    Ball* ball = slot;
+    // correct ball velocity if colliding with table
+    Vector tableBallDeltaV = resolveCollision(m_table, ball);
+    if (!tableBallDeltaV.isNull()) emitEvent(PhysicsEvent::WallHit, ball, tableBallDeltaV);
+    // test and resolve breakages with balls bouncing off table
+    if (ball->applyBreak(tableBallDeltaV, m_added)) {
+        // mark this ball to be deleted
+        m_removed.push_back(ball);
+        emitEvent(PhysicsEvent::Break, ball, tableBallDeltaV);
+        // nullify this ball
+        slot = nullptr;
+        return false;
+    }
+
+    // check whether ball should be swallowed
+    const Table::Sinking sinking = m_table->sinks(ball, m_rng);
+    if (sinking == Table::Sunk) {
+        emitEvent(PhysicsEvent::Sink, ball, Vector());
+        // defer swallowing until later (messes iterators otherwise)
+        m_removed.push_back(ball);
+        // nullify this ball
+        slot = nullptr;
+        return false;
+    }
+    if (sinking == Table::Teleported) {
+        emitEvent(PhysicsEvent::Teleport, ball, ball->velocity());
+        // the pairs are found again next step
+        m_contacts.invalidate();
+        return true;
+    }
+    return false;
+}
+
+void Game::advance(Ball *&slot, double dt) {
+    Ball* ball = slot;
+    const Real friction = m_table->getFriction();
+    // how far we'd go in one go, and how many radii-sized pieces that should be cut into
+    const Real travel = ball->velocity().length() * Real(dt);
+    const int substeps = m_localStepping ?
+                std::min(MaxSubsteps, std::max(1, int(std::ceil(travel / (SubstepTravel * ball->getRadius()))))) : 1;
+    if (substeps == 1) {
+        Physics<Real>::integrate(ball->position(), ball->velocity(), friction, Real(dt));
+        return;
+    }
+
+    // everyone else stays put until the step is over, so only the balls we can reach at this speed can be hit.
+    //  the contact grid has them where they were, give or take how far any of them has moved since
+    m_contacts.around(ball->position(), travel + ball->getRadius() + std::sqrt(m_movedSquared), m_reachable);
+    auto unreachable = [&](unsigned i) {
+        const Ball* other = (*m_balls)[i];
+        if (other == nullptr || other == ball) return true;
+        const Real apart = travel + ball->getRadius() + other->getRadius();
+        return (other->position() - ball->position()).lengthSquared() > apart * apart;
+    };
+    m_reachable.erase(std::remove_if(m_reachable.begin(), m_reachable.end(), unreachable), m_reachable.end());
+
+    const Real h = Real(dt) / substeps;
+    for (int s = 0; s < substeps; ++s) {
+        // the first substep starts where the step did, which has been resolved already
+        if (s > 0) {
+            const bool teleported = hitTable(slot);
+            if (slot == nullptr) return;
+            if (teleported) {
+                // somewhere else entirely, so finish the step in one go
+                Physics<Real>::integrate(ball->position(), ball->velocity(), friction, h * (substeps - s));
+                return;
+            }
+            for (unsigned i : m_reachable) {
+                Ball*& other = (*m_balls)[i];
+                if (other != nullptr && collidePair(slot, other)) return;
+            }
+        }
+        Physics<Real>::integrate(ball->position(), ball->velocity(), friction, h);
+    }
+}
+
+bool Game::collidePair(Ball *&ballA, Ball *&ballB) {
+    if (!isColliding(ballA, ballB)) return false;
+    // retrieve the changes in velocities for each ball and resolve collision
+    Vector ballADeltaV,ballBDeltaV;
+    std::tie(ballADeltaV, ballBDeltaV) = resolveCollision(ballA, ballB);
+    // touching but already moving apart isn't worth telling anyone about (it happens every substep, too)
+    if (!ballADeltaV.isNull() || !ballBDeltaV.isNull()) emitCollision(ballA, ballADeltaV, ballB, ballBDeltaV);
+
+    // remove ball, and add children to table vector if breaking
+    if (ballA->applyBreak(ballADeltaV, m_added)) {
+        m_removed.push_back(ballA);
+        emitEvent(PhysicsEvent::Break, ballA, ballADeltaV);
+        // nullify this ball
+        ballA = nullptr;
+        return true;
+    }
+    // remove ball, and add children to table vector if breaking
+    if (ballB->applyBreak(ballBDeltaV, m_added)) {
+        m_removed.push_back(ballB);
+        emitEvent(PhysicsEvent::Break, ballB, ballBDeltaV);
+        // nullify this ball
+        ballB = nullptr;
+    }
+    return false;
+}
+
+void Game::emitEvent(PhysicsEvent::Type type, const Ball *ball, const Vector &deltaV) {
+    PhysicsEvent e;
+    e.type = type;
+    e.ball = PhysicsEvent::Subject{ball->getBehaviours(), ball->getPosition(), double(deltaV.length())};
+    e.other = PhysicsEvent::Subject{NoBehaviour, QVector2D(), 0};
+    m_events.push_back(e);
+}
+
+void Game::emitCollision(const Ball *ballA, const Vector &deltaVA, const Ball *ballB, const Vector &deltaVB) {
+    PhysicsEvent e;
+    e.type = PhysicsEvent::Collision;
+    e.ball = PhysicsEvent::Subject{ballA->getBehaviours(), ballA->getPosition(), double(deltaVA.length())};
+    e.other = PhysicsEvent::Subject{ballB->getBehaviours(), ballB->getPosition(), double(deltaVB.length())};
+    m_events.push_back(e);
+}
+
+void Game::consumeEvents() {
+    for (const PhysicsEvent& e : m_events) {
+        switch (e.type) {
+        case PhysicsEvent::Collision: ++m_shot.collisions; break;
+        case PhysicsEvent::WallHit: ++m_shot.wallHits; break;
+        case PhysicsEvent::Sink: ++m_shot.sunk; break;
+        case PhysicsEvent::Break:
+            // breaking shakes the screen
+            incrementShake();
+            ++m_breaks;
+            ++m_shot.breaks;
+            break;
+        default:
+            break;
+        }
+    }
+    // smash balls crumble
+    m_effects.consume(m_events, m_rng);
+    // and anyone else gets them from the stream, in their own time
+    if (m_stream) m_stream->publish(m_events);
+    m_events.clear();
+}
+
+EventStream::Subscriber Game::subscribe() {
+    if (!m_stream) m_stream = std::make_shared<EventStream>();
+    return m_stream->subscribe();
 }
 
 void Game::updateShake(double dt) {
@@ -224,81 +478,60 @@ void Game::updateShake(double dt) {
 
     // update the screen shake per time step
     m_shakeRadius *= (1-dt)*0.9;
-    m_shakeAngle += (150 + rand()%60);
+    m_shakeAngle += (150 + randomInt(60));
     m_screenshake = QVector2D(sin(m_shakeAngle)*m_shakeRadius, cos(m_shakeAngle)*m_shakeRadius);
 }
 
 std::vector<Pocket *> *Game::getPockets(){
-    TableVisiter* visiter = new TableVisiter();
-    visiter->visitTable(m_table);
-    return visiter->getPockets();
+    // the pockets live in the table, the visiter just fetches them
+    if (m_pockets == nullptr) {
+        TableVisiter visiter;
+        m_pockets = visiter.visitTable(m_table);
+    }
+    return m_pockets;
 }
 
-QVector2D Game::resolveCollision(const Table* table, Ball* ball) {
-    QVector2D bPos = ball->getPosition();
-
-    QVector2D startingVel = ball->getVelocity();
+std::vector<size_t> Game::getSunkCounts(){
+    std::vector<size_t> counts;
+    std::vector<Pocket*>* pockets = getPockets();
+    if (pockets == nullptr) return counts;
+    for (const Pocket* p : *pockets) counts.push_back(p->getSunk());
+    return counts;
+}
 
-    // resulting multiplicity of direction. If a component is set to -1, it
-    // will flip the velocity's corresponding component
-    QVector2D vChange(1,1);
-
-    // ball is beyond left side of table's bounds
-    if (bPos.x() - ball->getRadius() <= 0) {
-        // flip velocity if wrong dir
-        if (ball->getVelocity().x() <= 0) vChange.setX(-1);
-    // ball is beyond right side of table's bounds
-    } else if (bPos.x() + ball->getRadius() >= 0 + table->getWidth()) {
-        // flip velocity if wrong dir
-        if (ball->getVelocity().x() >= 0) vChange.setX(-1);
-    }
-    // ball is above top of the table's bounds
-    if (bPos.y() - ball->getRadius() <= 0) {
-        // flip iff we're travelling in the wrong dir
-        if (ball->getVelocity().y() <= 0) vChange.setY(-1);
-    // ball is beyond bottom of table's bounds
-    } else if (bPos.y() + ball->getRadius() >= 0 + table->getHeight()) {
-        // if we're moving down (we want to let the ball bounce up if its heading back)
-        if (ball->getVelocity().y() >= 0) vChange.setY(-1);
+bool Game::isSettled() const {
+    for (const Ball* b : *m_balls) {
+        if (b->isMoving()) return false;
     }
-
-    ball->multiplyVelocity(vChange);
-
-    // return the change in velocity
-    return ball->getVelocity() - startingVel;
+    return true;
 }
 
-std::pair<QVector2D, QVector2D> Game::resolveCollision(Ball* ballA, Ball* ballB) {
-    // SOURCE : ASSIGNMENT SPEC
-
-    // if not colliding (distance is larger than radii)
-    QVector2D collisionVector = ballB->getPosition() - ballA->getPosition();
-    if (collisionVector.length() > ballA->getRadius() + ballB->getRadius()) {
-       throw std::logic_error("attempting to resolve collision of balls that do not touch");
-    }
-    collisionVector.normalize();
+bool Game::isQuiescent() const {
+    if (m_cue != nullptr && m_cue->dragging()) return false;
+    return m_shakeRadius < SHAKEEPSILON && m_effects.idle() && isSettled();
+}
 
-    QVector2D ballAStartingVelocity = ballA->getVelocity();
-    QVector2D ballBStartingVelocity = ballB->getVelocity();
+Vector Game::resolveCollision(const Table* table, Ball* ball) {
+    Vector startingVel = ball->velocity();
 
-    float mr = ballB->getMass() / ballA->getMass();
-    double pa = QVector2D::dotProduct(collisionVector, ballA->getVelocity());
-    double pb = QVector2D::dotProduct(collisionVector, ballB->getVelocity());
+    // resulting multiplicity of direction. If a component is set to -1, it
+    // will flip the velocity's corresponding component
+    ball->multiplyVelocity(Physics<Real>::bounce(ball->position(), ball->velocity(), ball->getRadius(),
+                                                 table->getWidth(), table->getHeight()));
 
-    if (pa <= 0 && pb >= 0) return std::make_pair(QVector2D(0,0), QVector2D(0,0));
+    // return the change in velocity
+    return ball->velocity() - startingVel;
+}
 
-    double a = -(mr + 1);
-    double b = 2*(mr * pb + pa);
-    double c = -((mr - 1)*pb*pb + 2*pa*pb);
-    double disc = sqrt(b*b - 4*a*c);
-    double root = (-b + disc)/(2*a);
-    if (root - pb < 0.01) {
-        root = (-b - disc)/(2*a);
-    }
+std::pair<Vector, Vector> Game::resolveCollision(Ball* ballA, Ball* ballB) {
+    // not colliding (distance is larger than radii), so nothing changes
+    if (!isColliding(ballA, ballB)) return std::make_pair(Vector(), Vector());
 
-    ballA->changeVelocity(mr * (pb - root) * collisionVector);
-    ballB->changeVelocity((root-pb) * collisionVector);
+    std::pair<Vector, Vector> deltaV = Physics<Real>::collide(ballA->position(), ballA->velocity(), ballA->getMass(),
+                                                              ballB->position(), ballB->velocity(), ballB->getMass());
+    ballA->changeVelocity(deltaV.first);
+    ballB->changeVelocity(deltaV.second);
 
     // return the change in velocities for the two balls
-    return std::make_pair(ballA->getVelocity() - ballAStartingVelocity, ballB->getVelocity() - ballBStartingVelocity);
+    return deltaV;
 }
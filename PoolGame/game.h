@@ -1,18 +1,44 @@
 #pragma once
 #include <QJsonObject>
 #include <functional>
+#include <algorithm>
+#include <random>
 #include <QMouseEvent>
 
 #include "abstractstagefactory.h"
 
 #include "table.h"
 #include "ball.h"
-#include "balldecorator.h"
+#include "ballbehaviours.h"
+#include "eventstream.h"
 #include "utils.h"
 #include "visiter.h"
 #include "strategy.h"
+#include "governor.h"
+#include "contactcache.h"
+
+/**
+ * @brief The ShotSummary struct
+ * What happened during a shot, i.e. from when something starts moving until it all settles again
+ */
+struct ShotSummary {
+    // which shot of the game this was, counting from 1
+    size_t shot = 0;
+    size_t steps = 0;
+    // simulated seconds it took
+    double duration = 0;
+    // ball on ball, and ball on table
+    size_t collisions = 0;
+    size_t wallHits = 0;
+    size_t breaks = 0;
+    size_t sunk = 0;
+    // balls left on the table afterwards
+    size_t ballsLeft = 0;
+};
 
 class Game {
+    // checkpoints store (and restore) everything, including our random source
+    friend class ScenarioCache;
     //if the game needs to be saved in next update
     bool m_save;
     //choose strategy between no visual aid and visual aid
@@ -22,17 +48,60 @@ class Game {
 
     std::vector<Ball*>* m_balls;
     Table* m_table;
+    // the cue behaviour of the cue ball (if we have one)
+    CueBall* m_cue = nullptr;
+    // the sparkle/smash behaviours' particles
+    BallEffects m_effects;
+    // what happened during the current physics step, consumed by the behaviours (and the stream) afterwards
+    std::vector<PhysicsEvent> m_events;
+    // where the events go for the subscribers, only made once there is one
+    std::shared_ptr<EventStream> m_stream;
+    // the balls removed (they're set to nullptr during the step) and added by the current step.
+    // kept between steps, so their memory is too
+    std::vector<Ball*> m_removed;
+    std::vector<Ball*> m_added;
+    // the pairs of balls close enough to collide, kept between steps
+    ContactCache m_contacts;
+    // whether fast balls cut their step into substeps (see advance), and scratch space for the balls they can reach
+    bool m_localStepping = false;
+    std::vector<unsigned> m_reachable;
+    // (squared) the furthest any ball has moved so far this step, i.e. how stale the contact grid is
+    Real m_movedSquared = 0;
+    // the most of its radius a ball moves in a substep, and the most substeps it takes
+    static constexpr Real SubstepTravel = 0.5;
+    static constexpr int MaxSubsteps = 64;
+    // the table's pockets, fetched by getPockets the first time they're needed
+    std::vector<Pocket*>* m_pockets = nullptr;
+    // every game has its own random source, so games can run side by side (and be replayed from a seed)
+    std::mt19937 m_rng;
+    // how many balls have broken so far
+    size_t m_breaks = 0;
+    // the shot being played (counted into even when there isn't one, it's reset when a shot starts), and the last one
+    ShotSummary m_shot;
+    ShotSummary m_lastShot;
+    bool m_shooting = false;
+    // told whenever a shot finishes
+    std::function<void(const ShotSummary&)> m_shotListener;
+    // how much effort goes into drawing us, and how many steps since the aid was last updated
+    RenderQuality m_quality;
+    int m_aidSteps = 0;
+    // the balls bucketed into coarse tiles, rebuilt each frame to find the ones in view
+    CircleGrid m_tiles;
+    std::vector<unsigned> m_visible;
+    static constexpr double TILESIZE = 256.0;
     // screenshake stuff
     QVector2D m_screenshake;
     double m_shakeRadius = 0.0;
     double m_shakeAngle = 0;
     static constexpr double SCREENSHAKEDIST = 10.0;
+    // any less shake than this can't be seen
+    static constexpr double SHAKEEPSILON = 0.1;
 
     /* increase the amount of screen shake */
     void incrementShake(double amount=SCREENSHAKEDIST) { m_shakeRadius += amount; }
 private:
-    // store the functions that get scanned through whenever a mouse event happens
-    MouseEventable::EventQueue m_mouseEventFunctions;
+    // store who gets told whenever a mouse event happens, per event type
+    MouseEventable::EventQueues m_mouseEventFunctions;
 
     /**
      * @brief updateShake - update the screenshake radius (make it smaller)
@@ -41,36 +110,102 @@ private:
     void updateShake(double dt);
 
     /**
-     * @brief getPockets utalise visiter to get pocket from table
+     * @brief getPockets utalise visiter to get pocket from table (only once, the table never changes)
      * @return a vector of pockets
      */
     std::vector<Pocket*>* getPockets();
 
+    // the sizes of the random balls, and how many spots are tried for each before giving up on it
+    static constexpr int MinSpawnRadius = 10;
+    static constexpr int MaxSpawnRadius = 30;
+    static constexpr int SpawnAttempts = 30;
+
     /**
      * @brief generateBall - generates a random ball
-     * @param max_x - the width of the table
-     * @param max_y - the height of the table
-     * @return a ball located within the table
+     * @param position - where the ball goes
+     * @param radius - the ball's radius
+     * @param composite - whether it's a stage two ball (which can break), rather than a stage one ball
+     * @return a ball at the position, at rest
      */
-    CompositeBall *generateBall(int max_x, int max_y);
+    Ball *generateBall(const Vector& position, int radius, bool composite);
 
     /**
-     * @brief generateSubBall - generate a random ball inside of other ball
+     * @brief generateSubBall - generate the blueprint of a random ball inside of other ball
      * @param radius - the containing ball's radius
-     * @return a ball within the given ball
+     * @return a blueprint node within the given ball
+     */
+    BallNode generateSubBall(int radius);
+
+    /* a random integer in [0, n) from our own random source */
+    int randomInt(int n) { return int(m_rng() % n); }
+
+    /**
+     * @brief randomBehaviour - pick a random decorative behaviour
+     * @return crumb, sparkle or no behaviour (BallBehaviour)
+     */
+    int randomBehaviour();
+
+    /**
+     * @brief adoptCue - find the ball flagged as the cue, and give it the cue behaviour component
+     */
+    void adoptCue();
+
+    /**
+     * @brief hitTable - bounce the ball off the table's edges, then break it or sink it if it should
+     * @param slot - the ball's slot in m_balls, nulled if it's gone
+     * @return whether it came out of another pocket, i.e. it's somewhere else now
+     */
+    bool hitTable(Ball*& slot);
+
+    /**
+     * @brief advance - move the ball along its velocity for the step, and apply friction.
+     *  With local stepping, a ball moving more than SubstepTravel of its radius is moved in as many substeps
+     *  as that takes, colliding with the table and the balls in reach in between (so it can't tunnel through
+     *  them). The other balls stay where they are until their own turn, so everything syncs up every step
+     * @param slot - the ball's slot in m_balls, nulled if it breaks or sinks along the way
+     * @param dt - the step's timestep
+     */
+    void advance(Ball*& slot, double dt);
+
+    /**
+     * @brief collidePair - resolve a collision of two balls during the step, if they touch
+     * @param ballA - the slot in m_balls of the ball whose turn it is, nulled if it breaks
+     * @param ballB - the later ball's slot, nulled if it breaks
+     * @return whether ballA broke, so there's nothing left for it to collide with
+     */
+    bool collidePair(Ball*& ballA, Ball*& ballB);
+
+    /**
+     * @brief emitEvent - record something that happened to a ball, for after the step
+     * @param type - what happened (anything but a collision)
+     * @param ball - the ball it happened to
+     * @param deltaV - the change in its velocity (or its new velocity, for a strike or teleport)
      */
-    CompositeBall *generateSubBall(int radius);
+    void emitEvent(PhysicsEvent::Type type, const Ball* ball, const Vector& deltaV);
 
     /**
-     * @brief decrateBall - add random decoration to the ball
-     * @return a ball decorated with crumb, sparkle or nothing
+     * @brief emitCollision - record two balls colliding, for after the step
+     * @param deltaVA - the change in ballA's velocity
+     * @param deltaVB - the change in ballB's velocity
      */
-    Ball *decrateBall(Ball *ball);
+    void emitCollision(const Ball* ballA, const Vector& deltaVA, const Ball* ballB, const Vector& deltaVB);
+
+    /**
+     * @brief consumeEvents - react to the step's events (shake, particles, shot stats), then publish them to the stream
+     */
+    void consumeEvents();
+
+    /**
+     * @brief trackShot - count the step towards the shot being played, and finish it once it has all settled
+     * @param dt - the step's timestep
+     */
+    void trackShot(double dt);
 public:
     ~Game();
     Game(std::vector<Ball*>* balls, Table* table) :
         m_save(false), m_balls(balls), m_table(table), m_stageThree(false){
         m_strategy = new NoStrategy(m_balls,getPockets()); //default with no aid
+        adoptCue();
     }
     //copy constructor
     Game(Game& game);
@@ -80,6 +215,11 @@ public:
      */
     void switchMode(){m_strategy = m_strategy->switchMode();}
 
+    /**
+     * @return whether the visual aid is being shown
+     */
+    bool isAiding() const { return m_strategy->aids(); }
+
     /**
      * @return if the game needs to be saved
      */
@@ -96,15 +236,92 @@ public:
     Game* clone();
 
     /**
-     * @brief findCue - goes through all the balls and find the cue ball
-     * @return the cue ball
+     * @brief findCue - the cue behaviour of the cue ball
+     * @return the cue ball's component, or nullptr if there is no cue ball
      */
-    CueBall* findCue();
+    CueBall* findCue() { return m_cue; }
 
     /**
      * @brief addRandomBall - add a random ball to the game
+     * @return false if there was no room left for it
+     */
+    bool addRandomBall() { return addRandomBalls(1) == 1; }
+
+    /**
+     * @brief addRandomBalls - add random balls to the game all at once, in the free space left on the table
+     * @param count - how many balls to add
+     * @return how many were added, fewer than count once the table is full
+     */
+    size_t addRandomBalls(size_t count);
+
+    /**
+     * @brief seed - reseed our random source
+     * @param seed - the seed
+     */
+    void seed(unsigned seed) { m_rng.seed(seed); }
+
+    /**
+     * @brief isSettled - whether every ball has come to rest
+     */
+    bool isSettled() const;
+
+    /**
+     * @brief isQuiescent - whether stepping the game would change nothing on screen: every ball is at rest,
+     *  the particles have faded, the screen has stopped shaking and no shot is being lined up
+     */
+    bool isQuiescent() const;
+
+    /**
+     * @brief isShotOver - whether the shot has settled: every ball is at rest, and every particle has faded
+     */
+    bool isShotOver() const { return isSettled() && m_effects.idle(); }
+
+    /**
+     * @brief shotInProgress - whether a shot is being played, or is about to start (i.e. the cue was just hit)
+     */
+    bool shotInProgress() const { return m_shooting || !isSettled(); }
+
+    /**
+     * @brief lastShot - the summary of the last shot to finish
+     */
+    const ShotSummary& lastShot() const { return m_lastShot; }
+
+    /**
+     * @brief setShotListener - be told the summary of every shot as it finishes (during animate)
+     * @param listener - the callback, an empty one to stop listening
+     */
+    void setShotListener(const std::function<void(const ShotSummary&)>& listener) { m_shotListener = listener; }
+
+    /**
+     * @brief finishShot - simulate the rest of the shot as fast as possible, without drawing any of it
+     * @param dt - the timestep to simulate at
+     * @param maxSteps - most steps to take, in case it never settles
+     * @return how many steps were taken
+     */
+    size_t finishShot(double dt, size_t maxSteps);
+
+    /**
+     * @brief subscribe - read the events of every step from now on (collisions, wall hits, breaks, sinks, strikes
+     *  and teleports). Call it from the thread that steps the game, the subscriber can then be polled from any thread
+     * @return the subscriber, it keeps the stream alive after the game is gone
+     */
+    EventStream::Subscriber subscribe();
+
+    /**
+     * @brief setLocalStepping - whether fast balls take substeps of their own, rather than the whole step at once.
+     *  Slow balls are stepped the same either way, so the time goes where the motion is
+     */
+    void setLocalStepping(bool on) { m_localStepping = on; }
+    bool localStepping() const { return m_localStepping; }
+
+    /* how many balls have broken so far */
+    size_t getBreaks() const { return m_breaks; }
+
+    /**
+     * @brief getSunkCounts - how many balls each pocket has sunk so far
+     * @return the counts, in the table's pocket order (empty for tables without pockets)
      */
-    void addRandomBall();
+    std::vector<size_t> getSunkCounts();
 
     /**
      * @brief setStageThree - set stageThree to add addtional features
@@ -116,11 +333,44 @@ public:
      */
     bool isStageThree() const{return m_stageThree;}
 
+    /**
+     * @brief setQuality - how much effort to put into drawing from now on, see QualityGovernor
+     */
+    void setQuality(const RenderQuality& quality) { m_quality = quality; }
+
     /**
      * @brief Draws all owned objects to the screen (balls and table)
      * @param painter - qtpainter to blit to screen with
+     * @param view - the part of the table that can be seen, only what's in it is drawn. a null rect draws everything
+     */
+    void render(QPainter& painter, const QRectF& view = QRectF());
+
+    /**
+     * @brief prepareRender - get ready to draw the view (or any part of it) with renderView
+     * @param view - the part of the table that can be seen, a null rect for everything
+     */
+    void prepareRender(const QRectF& view);
+
+    /**
+     * @brief renderView - draw the part of the table in the view. Doesn't change the game, so different views
+     *  can be drawn at once (i.e. on different threads), as long as they are all in the one given to prepareRender
+     * @param painter - qtpainter to blit to screen with
+     * @param view - the part of the table to draw, a null rect draws everything
+     * @param visible - scratch space for the balls in view
+     */
+    void renderView(QPainter& painter, const QRectF& view, std::vector<unsigned>& visible) const;
+
+    /* what renderView draws, bottom to top */
+    enum RenderLayer { TableLayer, BallLayer, EffectLayer, AidLayer, LayerCount };
+
+    /**
+     * @brief renderLayer - draw a single layer of the view, like renderView does (i.e. to time them apart)
+     * @param layer - the layer to draw
      */
-    void render(QPainter& painter);
+    void renderLayer(QPainter& painter, RenderLayer layer, const QRectF& view, std::vector<unsigned>& visible) const;
+
+    /* how many sparkles & crumbs there are */
+    size_t getParticleCount() const { return m_effects.size(); }
 
     /**
      * @brief Updates the positions of all objects within, based on how much time has changed
@@ -128,6 +378,11 @@ public:
      */
     void animate(double dt);
 
+    /* the balls currently in play */
+    const std::vector<Ball*>& getBalls() const { return *m_balls; }
+    /* the table being played on */
+    Table* getTable() { return m_table; }
+
     /* how large the window's width should at least be */
     int getMinimumWidth() const { return m_table->getWidth(); }
     /* how large the window's height should at least be */
@@ -138,14 +393,14 @@ public:
      * @param ball - the ball to move
      * @return velocity - the change of velocity that a ball underwent
      */
-    QVector2D resolveCollision(const Table* table, Ball* ball);
+    Vector resolveCollision(const Table* table, Ball* ball);
     /**
      * @brief resolveCollision - resolve both ball's velocity whether these balls collide
      * @param ballA - first ball
      * @param ballB - second ball
-     * @param pair<deltaVelocityA, deltaVelocityB> - the change of velocities for each ball
+     * @param pair<deltaVelocityA, deltaVelocityB> - the change of velocities for each ball, both null if they don't touch
      */
-    std::pair<QVector2D, QVector2D> resolveCollision(Ball* ballA, Ball* ballB);
+    std::pair<Vector, Vector> resolveCollision(Ball* ballA, Ball* ballB);
 
     /**
      * @brief isColliding - returns whether two balls are touching each other
@@ -154,23 +409,35 @@ public:
      * @return whether the two balls are touching each other
      */
     bool isColliding(const Ball* ballA, const Ball* ballB) {
-        QVector2D collisionVector = ballB->getPosition() - ballA->getPosition();
-        return !(collisionVector.length() > ballA->getRadius() + ballB->getRadius());
+        return Physics<Real>::touching(ballA->position(), ballA->getRadius(), ballB->position(), ballB->getRadius());
+    }
+
+    /**
+     * @brief addMouseFunctions - append the handler to the eventqueues of
+     *  every event type it overrides - these will be cycled through onclick, etc
+     * @param handler
+     */
+    void addMouseFunctions(MouseEventable* handler) {
+        for (int t = 0; t < MouseEventable::EventCount; ++t) {
+            if (handler->handles(MouseEventable::EVENTS(t))) m_mouseEventFunctions[t].push_back(handler);
+        }
     }
 
     /**
-     * @brief addMouseFunctions - append all of the specified functions to be
-     *  our eventqueue - these will be cycled through onclick, etc
-     * @param fns
+     * @brief removeMouseFunctions - stop sending events to the handler, call before deleting it
+     * @param handler
      */
-    void addMouseFunctions(MouseEventable::EventQueue fns) {
-        std::copy(fns.begin(), fns.end(), std::back_inserter(m_mouseEventFunctions));
+    void removeMouseFunctions(MouseEventable* handler) {
+        for (MouseEventable::EventQueue& queue : m_mouseEventFunctions) {
+            queue.erase(std::remove(queue.begin(), queue.end(), handler), queue.end());
+        }
     }
 
     /**
-     * @brief getEventFns - get all of our event functions (mouseclicksfns, etc)
-     * @return event queue of event functions
+     * @brief getEventFns - get everyone listening for an event type (mouseclicks, etc)
+     * @param t - the event type
+     * @return event queue of handlers
      */
-    MouseEventable::EventQueue& getEventFns() { return m_mouseEventFunctions; }
+    const MouseEventable::EventQueue& getEventFns(MouseEventable::EVENTS t) const { return m_mouseEventFunctions[t]; }
 
 };
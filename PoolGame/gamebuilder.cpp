@@ -36,6 +36,13 @@ Game* GameBuilder::getResult() {
     return retGame;
 }
 
+void GameBuilder::addBalls(const QJsonArray &ballData) {
+    for (const auto& item : ballData) {
+        QJsonObject t = item.toObject();
+        addBall(t);
+    }
+}
+
 void StageOneBuilder::addBall(QJsonObject &ballData) {
     // if we haven't already started building
     if (m_buildingBalls == nullptr) {
@@ -57,10 +64,7 @@ Game* GameDirector::createGame() {
 
     // for each of our balls, construct them
     QJsonArray ballData = m_conf->value("balls").toArray();
-    for (const auto& item : ballData) {
-        QJsonObject t = item.toObject();
-        m_builder->addBall(t);
-    }
+    m_builder->addBalls(ballData);
 
     return m_builder->getResult();
 }
@@ -2,6 +2,7 @@
 #include "stageonefactory.h"
 #include "stagetwofactory.h"
 #include "game.h"
+#include <QJsonArray>
 
 class GameBuilder {
 protected:
@@ -17,6 +18,12 @@ public:
      */
     virtual void addBall(QJsonObject& ballData) = 0;
 
+    /**
+     * @brief addBalls creates every ball in the array, in order
+     * @param ballData - the array of balls provided in the config
+     */
+    virtual void addBalls(const QJsonArray& ballData);
+
     /**
      * @brief addTable creates a table to the current game being built
      * @param tableData - json object that contains all properties of the table
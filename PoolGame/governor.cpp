@@ -0,0 +1,42 @@
+#include "governor.h"
+#include <QString>
+
+bool QualityGovernor::painted(qint64 ns) {
+    m_paintMS += Smoothing * (ns / 1e6 - m_paintMS);
+
+    const double load = (m_paintMS + m_stepMS) / m_budget;
+    m_slowFrames = load > DegradeLoad ? m_slowFrames + 1 : 0;
+    m_fastFrames = load < RestoreLoad ? m_fastFrames + 1 : 0;
+
+    Tier tier = m_tier;
+    if (m_slowFrames >= DegradeFrames && m_tier + 1 < TierCount) tier = Tier(m_tier + 1);
+    else if (m_fastFrames >= RestoreFrames && m_tier > Full) tier = Tier(m_tier - 1);
+    if (tier == m_tier) return false;
+
+    // give the new tier a chance to show what it's worth before judging it
+    m_tier = tier;
+    m_slowFrames = 0;
+    m_fastFrames = 0;
+    return true;
+}
+
+RenderQuality QualityGovernor::quality() const {
+    RenderQuality q;
+    // every tier keeps what the tiers before it gave up
+    if (m_tier >= NoAntialiasing) q.antialiasing = false;
+    if (m_tier >= FewerParticles) q.particleCap = ParticleCap;
+    if (m_tier >= NoChildren) q.renderChildren = false;
+    if (m_tier >= SlowAid) q.aidInterval = SlowAidInterval;
+    if (m_tier >= SlowRender) q.renderInterval = SlowRenderInterval;
+    return q;
+}
+
+void QualityGovernor::render(QPainter &painter) const {
+    static const char* names[TierCount] = {"full", "no antialiasing", "fewer particles",
+                                           "no children", "slow aid", "slow render"};
+    painter.setOpacity(1.0);
+    painter.setPen(QColor(Qt::white));
+    painter.drawText(10, 20, QString("tier %1/%2 (%3)").arg(int(m_tier)).arg(int(TierCount) - 1).arg(names[m_tier]));
+    painter.drawText(10, 36, QString("paint %1ms  step %2ms  budget %3ms")
+                     .arg(m_paintMS, 0, 'f', 2).arg(m_stepMS, 0, 'f', 2).arg(m_budget, 0, 'f', 1));
+}
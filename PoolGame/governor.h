@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QPainter>
+#include <limits>
+#include "utils.h"
+
+/**
+ * @brief The RenderQuality struct
+ * How much effort goes into drawing the game. None of it changes the simulation, so a game
+ *  plays out the same at any quality
+ */
+struct RenderQuality {
+    bool antialiasing = true;
+    // most particles drawn in a frame, the newest ones
+    size_t particleCap = std::numeric_limits<size_t>::max();
+    // whether the balls nested inside of balls are drawn
+    bool renderChildren = true;
+    // steps between updates of the visual aid
+    int aidInterval = 1;
+    // how many render timer intervals between frames
+    int renderInterval = 1;
+};
+
+/**
+ * @brief The QualityGovernor class
+ * Measures how long painting & stepping take, and trades away quality whenever a frame doesn't fit
+ *  in its budget (drawFrameMS), rather than letting the whole game slow down. Each tier gives up one
+ *  more thing, in order. Quality comes back a tier at a time once there's plenty of headroom again.
+ */
+class QualityGovernor {
+public:
+    enum Tier { Full, NoAntialiasing, FewerParticles, NoChildren, SlowAid, SlowRender, TierCount };
+
+    /**
+     * @param budgetMS - how long a step & a paint together can take
+     */
+    QualityGovernor(double budgetMS = drawFrameMS) : m_budget(budgetMS) {}
+
+    /**
+     * @brief stepped - a step of the simulation took this long
+     * @param ns - nanoseconds
+     */
+    void stepped(qint64 ns) { m_stepMS += Smoothing * (ns / 1e6 - m_stepMS); }
+
+    /**
+     * @brief painted - a frame took this long to paint, move between tiers if it's time to
+     * @param ns - nanoseconds
+     * @return whether the tier changed, i.e. quality() needs applying again
+     */
+    bool painted(qint64 ns);
+
+    Tier tier() const { return m_tier; }
+    /* the quality of the current tier */
+    RenderQuality quality() const;
+    /* the smoothed times, in milliseconds */
+    double paintMS() const { return m_paintMS; }
+    double stepMS() const { return m_stepMS; }
+
+    /**
+     * @brief render - draw the debug overlay, the tier and the timings
+     * @param painter - the brush to use to draw
+     */
+    void render(QPainter& painter) const;
+
+private:
+    // how much each new measurement counts towards the smoothed times
+    static constexpr double Smoothing = 0.1;
+    // a frame over this much of the budget is too slow, one under the restore load has headroom
+    static constexpr double DegradeLoad = 0.9;
+    static constexpr double RestoreLoad = 0.5;
+    // how many frames in a row it takes to move down a tier, and back up (slower, so we don't flicker)
+    static constexpr int DegradeFrames = 30;
+    static constexpr int RestoreFrames = 120;
+    // what the tiers turn down to
+    static constexpr size_t ParticleCap = 200;
+    static constexpr int SlowAidInterval = 10;
+    static constexpr int SlowRenderInterval = 2;
+
+    double m_budget;
+    double m_paintMS = 0;
+    double m_stepMS = 0;
+    Tier m_tier = Full;
+    // frames in a row over/under budget
+    int m_slowFrames = 0;
+    int m_fastFrames = 0;
+};
@@ -0,0 +1,196 @@
+#include "jsonpullreader.h"
+#include <cstdlib>
+
+bool JsonPullReader::get(char &c) {
+    if (m_bufferPos == m_bufferSize) {
+        m_bufferSize = m_device->read(m_buffer, ChunkSize);
+        m_bufferPos = 0;
+        if (m_bufferSize <= 0) {
+            m_bufferSize = 0;
+            return false;
+        }
+    }
+    c = m_buffer[m_bufferPos++];
+    return true;
+}
+
+bool JsonPullReader::peekSignificant(char &c) {
+    while (get(c)) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') continue;
+        // we only ever need to look one character ahead
+        --m_bufferPos;
+        return true;
+    }
+    return false;
+}
+
+void JsonPullReader::finishValue() {
+    if (m_containers.empty()) {
+        m_done = true;
+        return;
+    }
+    // the next thing in an object is a key, after a comma
+    m_expectKey = m_containers.back();
+    m_separate = true;
+}
+
+JsonPullReader::Token JsonPullReader::next() {
+    char c;
+    // the root value has to be all there is
+    if (m_done) return peekSignificant(c) ? Invalid : EndOfDocument;
+    if (!peekSignificant(c)) return Invalid;
+    get(c);
+    // the values in a container are separated by commas, until it closes
+    if (m_separate) {
+        m_separate = false;
+        if (c == ',') {
+            if (!peekSignificant(c)) return Invalid;
+            get(c);
+            m_needValue = true;
+        } else if (c != '}' && c != ']') {
+            return Invalid;
+        }
+    }
+    // no trailing commas, or keys without a value
+    if (m_needValue && (c == '}' || c == ']')) return Invalid;
+    m_needValue = false;
+    // only keys (or the end) can come next in an object
+    if (m_expectKey && c != '"' && c != '}') return Invalid;
+
+    switch (c) {
+    case '{':
+        m_containers.push_back(true);
+        m_expectKey = true;
+        return BeginObject;
+    case '[':
+        m_containers.push_back(false);
+        m_expectKey = false;
+        return BeginArray;
+    case '}':
+    case ']':
+        if (m_containers.empty() || m_containers.back() != (c == '}')) return Invalid;
+        m_containers.pop_back();
+        finishValue();
+        return c == '}' ? EndObject : EndArray;
+    case '"':
+        if (!readString()) return Invalid;
+        if (m_expectKey) {
+            // the colon belongs to the key
+            if (!peekSignificant(c) || !get(c) || c != ':') return Invalid;
+            m_expectKey = false;
+            m_needValue = true;
+            return Key;
+        }
+        finishValue();
+        return String;
+    case 't':
+        if (!readLiteral("rue")) return Invalid;
+        m_bool = true;
+        finishValue();
+        return Bool;
+    case 'f':
+        if (!readLiteral("alse")) return Invalid;
+        m_bool = false;
+        finishValue();
+        return Bool;
+    case 'n':
+        if (!readLiteral("ull")) return Invalid;
+        finishValue();
+        return Null;
+    default:
+        if (c != '-' && (c < '0' || c > '9')) return Invalid;
+        if (!readNumber(c)) return Invalid;
+        finishValue();
+        return Number;
+    }
+}
+
+bool JsonPullReader::skip(Token t) {
+    if (t == Invalid || t == EndOfDocument || t == Key || t == EndObject || t == EndArray) return false;
+    if (t != BeginObject && t != BeginArray) return true;
+
+    // read until the container we're in closes
+    const size_t openDepth = depth();
+    while (depth() >= openDepth) {
+        t = next();
+        if (t == Invalid || t == EndOfDocument) return false;
+    }
+    return true;
+}
+
+bool JsonPullReader::readLiteral(const char *rest) {
+    char c;
+    for (; *rest != '\0'; ++rest) {
+        if (!get(c) || c != *rest) return false;
+    }
+    return true;
+}
+
+bool JsonPullReader::readNumber(char first) {
+    // numbers are short, so just gather the characters and let strtod do the hard work
+    char digits[64];
+    size_t len = 0;
+    digits[len++] = first;
+    char c;
+    while (get(c)) {
+        if (!((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')) {
+            --m_bufferPos;
+            break;
+        }
+        if (len == sizeof(digits) - 1) return false;
+        digits[len++] = c;
+    }
+    digits[len] = '\0';
+
+    char* end = nullptr;
+    m_number = strtod(digits, &end);
+    return end == digits + len;
+}
+
+bool JsonPullReader::readString() {
+    m_text.clear();
+    char c;
+    while (get(c)) {
+        if (c == '"') return true;
+        if (c != '\\') {
+            m_text.push_back(c);
+            continue;
+        }
+
+        if (!get(c)) return false;
+        switch (c) {
+        case '"': case '\\': case '/': m_text.push_back(c); break;
+        case 'b': m_text.push_back('\b'); break;
+        case 'f': m_text.push_back('\f'); break;
+        case 'n': m_text.push_back('\n'); break;
+        case 'r': m_text.push_back('\r'); break;
+        case 't': m_text.push_back('\t'); break;
+        case 'u': {
+            // re-encode the code unit as utf8. surrogate pairs are not combined, colours don't need them
+            unsigned int code = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (!get(c)) return false;
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= c - '0';
+                else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+                else return false;
+            }
+            if (code < 0x80) {
+                m_text.push_back((char) code);
+            } else if (code < 0x800) {
+                m_text.push_back((char) (0xC0 | (code >> 6)));
+                m_text.push_back((char) (0x80 | (code & 0x3F)));
+            } else {
+                m_text.push_back((char) (0xE0 | (code >> 12)));
+                m_text.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+                m_text.push_back((char) (0x80 | (code & 0x3F)));
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return false;
+}
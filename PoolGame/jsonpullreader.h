@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QIODevice>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The JsonPullReader class
+ * A streaming json tokenizer. Tokens are pulled one at a time from the device, so only the current
+ *  token and the stack of open containers are ever held in memory, no matter how large the document is.
+ */
+class JsonPullReader {
+public:
+    enum Token { BeginObject, EndObject, BeginArray, EndArray, Key, String, Number, Bool, Null, EndOfDocument, Invalid };
+
+    JsonPullReader(QIODevice* device) : m_device(device) {}
+
+    /**
+     * @brief next - read the next token
+     * @return the token, EndOfDocument once the root value is finished (and only whitespace follows it), or Invalid on malformed json
+     */
+    Token next();
+
+    /**
+     * @brief skipValue - read and skip over the next value (i.e. the value after a Key)
+     * @return false if the json is malformed
+     */
+    bool skipValue() { return skip(next()); }
+
+    /**
+     * @brief skip - skip over the rest of a value that has just been read
+     * @param t - the token that was just read. if it opened a container, everything up to its end is skipped
+     * @return false if the json is malformed
+     */
+    bool skip(Token t);
+
+    /* the text of the last Key or String token (utf8) */
+    const std::string& text() const { return m_text; }
+    /* the value of the last Number token */
+    double number() const { return m_number; }
+    /* the value of the last Bool token */
+    bool boolean() const { return m_bool; }
+    /* how many containers are currently open */
+    size_t depth() const { return m_containers.size(); }
+
+private:
+    // read chunks of this size from the device
+    static constexpr qint64 ChunkSize = 64*1024;
+
+    QIODevice* m_device;
+    char m_buffer[ChunkSize];
+    qint64 m_bufferSize = 0;
+    qint64 m_bufferPos = 0;
+
+    // the open containers, true for objects
+    std::vector<bool> m_containers;
+    // whether the next string in the current object is a key
+    bool m_expectKey = false;
+    // whether a value was just finished in a container, so a comma or the container's end comes next
+    bool m_separate = false;
+    // whether a comma or colon was just read, so a value (or key) comes next
+    bool m_needValue = false;
+    // whether we've finished the root value
+    bool m_done = false;
+
+    std::string m_text;
+    double m_number = 0;
+    bool m_bool = false;
+
+    /* peek at the next non-whitespace character, returns false at the end of the device */
+    bool peekSignificant(char& c);
+    /* read a single character, returns false at the end of the device */
+    bool get(char& c);
+    bool readString();
+    bool readNumber(char first);
+    bool readLiteral(const char* rest);
+    /* a value was just finished, so update what we expect next */
+    void finishValue();
+};
@@ -8,6 +8,10 @@
 #include "utils.h"
 #include "gamebuilder.h"
 #include "stagetwobuilder.h"
+#include "scenariocache.h"
+#include "streaminggamedirector.h"
+#include "ensemble.h"
+#include "alloccount.h"
 #include <QApplication>
 #include <QFile>
 #include <iostream>
@@ -16,27 +20,20 @@
 #include <ctime>
 #include <QJsonDocument>
 
-QJsonObject loadConfig() {
-    // load json from config file
-    QFile conf_file(config_path);
-    conf_file.open(QIODevice::ReadOnly | QIODevice::Text);
-    QString content = conf_file.readAll();
-    conf_file.close();
-    QJsonObject config = QJsonDocument::fromJson(content.toUtf8()).object();
-    return config;
-}
-
-int main(int argc, char *argv[])
-{
-    QJsonObject conf = loadConfig();
-
-    // seed our RNG
-    srand(time(nullptr));
+/**
+ * @brief buildGame - create the game from the json config (the slow path)
+ * @param content - the raw config
+ * @param hash - the config's hash, used to compile stage two configs into the scenario cache
+ * @return the newly built game
+ */
+Game* buildGame(const QByteArray& content, const QByteArray& hash) {
+    QJsonObject conf = QJsonDocument::fromJson(content).object();
 
     // create our game based on our config
     GameDirector director(&conf);
     // use builder2 if we're stage two (defaults to false), otherwise no
-    if (conf.value("stage2").toBool(false) == true) {
+    const bool stageTwo = conf.value("stage2").toBool(false);
+    if (stageTwo) {
        director.setBuilder(new StageTwoBuilder());
     } else {
         // set and transfer ownership of this builder to the director
@@ -45,13 +42,152 @@ int main(int argc, char *argv[])
 
     Game* game = director.createGame();
 
+    // a stage two config can ask for random balls on top of its own, they get compiled into the cache with the rest.
+    //  stage one balls can't nest or break, so stage one configs don't get any
+    if (stageTwo) game->addRandomBalls(std::max(0, conf.value("spawn").toInt(0)));
+    game->setLocalStepping(conf.value("localStepping").toBool(false));
+
+    quint32 flags = 0;
     if(conf.value("stage3").toBool(false) == true){
         game->setStageThree();
+        flags |= ScenarioCache::StageThree;
+    }
+    // only stage two is worth compiling, its validation is where the time goes
+    // the random decorations are left out of the cache, so every launch rolls them again
+    if (stageTwo) {
+        ScenarioCache::save(scenario_cache_path, hash, *game, flags);
+        StageTwoBuilder::decorate(*game);
+    }
+    return game;
+}
+
+/**
+ * @brief streamGame - create a stage two game by streaming the json config (never holding all of it)
+ * @param conf_file - the config file
+ * @param hash - the config's hash, used to compile it into the scenario cache
+ * @return the newly built game, or nullptr if it isn't a (valid) stage two config
+ */
+Game* streamGame(QFile& conf_file, const QByteArray& hash) {
+    StreamingGameDirector director(&conf_file);
+    Game* game = director.createGame();
+    if (game != nullptr) {
+        ScenarioCache::save(scenario_cache_path, hash, *game, director.isStageThree() ? ScenarioCache::StageThree : 0);
+        StageTwoBuilder::decorate(*game);
+    }
+    return game;
+}
+
+/**
+ * @brief runEnsemble - play the sweep's runs of the game headless, and report how they went
+ * @param game - the game every run starts from
+ * @param sweepPath - the sweep's json, see Ensemble::parseRuns (plus "dt" & "maxTime")
+ * @param reportPath - where to write the report, or nullptr for stdout
+ * @return the exit code
+ */
+int runEnsemble(Game* game, const char* sweepPath, const char* reportPath) {
+    QFile sweepFile(sweepPath);
+    if (!sweepFile.open(QIODevice::ReadOnly)) {
+        std::cerr << "unable to open sweep " << sweepPath << std::endl;
+        return 1;
+    }
+    QJsonObject sweep = QJsonDocument::fromJson(sweepFile.readAll()).object();
+    Ensemble ensemble(game, sweep.value("dt").toDouble(1.0/(double)animFrameMS), sweep.value("maxTime").toDouble(600.0));
+    QByteArray report = QJsonDocument(Ensemble::report(ensemble.run(Ensemble::parseRuns(sweep)))).toJson();
+
+    QFile out;
+    bool opened = reportPath == nullptr ? out.open(stdout, QIODevice::WriteOnly)
+                                        : (out.setFileName(reportPath), out.open(QIODevice::WriteOnly));
+    if (!opened || out.write(report) != report.size()) {
+        std::cerr << "unable to write the ensemble report" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief checkAllocations - play the game headless, and make sure the steady steps don't allocate.
+ *  A step is steady if nothing broke, sunk or was spawned during it (those are allowed to allocate)
+ * @param game - the game to play
+ * @param steps - how many steps to check, after the warm up
+ * @return the exit code, 1 if any steady step allocated
+ */
+int checkAllocations(Game* game, int steps) {
+    if (!AllocationCounter::enabled()) {
+        std::cerr << "allocations aren't counted in this build, rebuild with qmake CONFIG+=allocations" << std::endl;
+        return 1;
+    }
+    const double dt = 1.0/(double)animFrameMS;
+    // let the scratch space (and the particles) grow to their working size first
+    for (int i = 0; i < allocationWarmup; ++i) game->animate(dt);
+
+    int steady = 0, allocating = 0;
+    for (int i = 0; i < steps; ++i) {
+        const size_t breaks = game->getBreaks(), balls = game->getBalls().size();
+        const size_t before = AllocationCounter::count();
+        game->animate(dt);
+        const size_t allocated = AllocationCounter::count() - before;
+        if (game->getBreaks() != breaks || game->getBalls().size() != balls) continue;
+        ++steady;
+        if (allocated > 0) {
+            ++allocating;
+            std::cerr << "step " << (allocationWarmup + i) << " allocated " << allocated << " times" << std::endl;
+        }
+    }
+    std::cout << allocating << " of " << steady << " steady steps allocated (" << (steps - steady) << " weren't steady)" << std::endl;
+    return allocating == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    QFile conf_file(config_path);
+    conf_file.open(QIODevice::ReadOnly | QIODevice::Text);
+
+    // seed our RNG
+    srand(time(nullptr));
+
+    // skip the json entirely if we've already compiled this config
+    QByteArray hash = ScenarioCache::hash(&conf_file);
+    Game* game = ScenarioCache::load(scenario_cache_path, hash);
+    if (game != nullptr) StageTwoBuilder::decorate(*game);
+    // otherwise stream it in a single pass, falling back to the DOM for stage one configs
+    if (game == nullptr) {
+        conf_file.seek(0);
+        game = streamGame(conf_file, hash);
+    }
+    if (game == nullptr) {
+        conf_file.seek(0);
+        game = buildGame(conf_file.readAll(), hash);
+    }
+    conf_file.close();
+    game->seed(time(nullptr));
+
+    // ensemble mode, i.e. Poolgame --ensemble sweep.json [report.json]
+    if (argc >= 3 && QString(argv[1]) == "--ensemble") {
+        int ret = runEnsemble(game, argv[2], argc > 3 ? argv[3] : nullptr);
+        delete game;
+        return ret;
+    }
+
+    // check the simulation doesn't allocate, i.e. Poolgame --check-allocations [steps]
+    if (argc >= 2 && QString(argv[1]) == "--check-allocations") {
+        int ret = checkAllocations(game, argc > 2 ? std::max(1, atoi(argv[2])) : allocationCheckSteps);
+        delete game;
+        return ret;
+    }
+
+    // pick up a saved session instead, i.e. Poolgame --resume game.checkpoint
+    std::vector<Game*> history;
+    if (argc >= 3 && QString(argv[1]) == "--resume") {
+        Game* resumed = ScenarioCache::loadCheckpoint(argv[2], history);
+        if (resumed != nullptr) {
+            delete game;
+            game = resumed;
+        }
     }
 
     // display our dialog that contains our game and run
     QApplication a(argc, argv);
-    Dialog w(game, nullptr);
+    Dialog w(game, nullptr, history);
     w.show();
 
     return a.exec();
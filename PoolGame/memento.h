@@ -1,28 +1,46 @@
 #ifndef MEMENTO_H
 #define MEMENTO_H
+#include <QFuture>
+#include <QtConcurrent>
 #include "game.h"
+#include "scenariocache.h"
 /**
  * @brief The Memento class creates a copy of current game for restoring later
+ *  Only the game's records are copied straight away, the game itself is built from them
+ *  on the thread pool, so the frame a shot is taken on doesn't pay for a whole clone
  */
 class Memento
 {
 public:
-    virtual ~Memento(){}
+    // never leave a build running with nobody to take its game
+    virtual ~Memento(){m_game.waitForFinished();}
 
 private:
     // only allows Originator to access the private member variables and functions
     friend class Originator;
 
-    //constructed with the copy of the game
-    Memento(Game* game){m_game = game->clone();}
+    //constructed with the records of the game, which are turned back into a game later
+    Memento(Game* game){
+        QByteArray state = ScenarioCache::snapshot(*game);
+        m_game = QtConcurrent::run([state]() {
+            Game* saved = ScenarioCache::restore(state);
+            // like a clone, the cue ball goes back to where it was shot from
+            CueBall* cue = saved != nullptr ? saved->findCue() : nullptr;
+            if (cue != nullptr) {
+                cue->ball()->setVelocity(QVector2D());
+                cue->ball()->setPosition(cue->savedPosition());
+            }
+            return saved;
+        });
+    }
 
     /**
-     * @return the game that been saved
+     * @return the game that been saved, waiting for it to be built if it hasn't been yet
      */
-    Game* getGame(){return m_game;}
+    Game* getGame(){return m_game.result();}
 
 private:
-    Game* m_game;
+    QFuture<Game*> m_game;
 };
 
 #endif // MEMENTO_H
@@ -1,86 +1,74 @@
 #pragma once
 
 #include <QMouseEvent>
+#include <array>
+#include <type_traits>
+#include <vector>
 
 /**
  * @brief The MouseEventable class
  *  go away
  *
  * Inherit this class & override the mouse___Event(QMouseEvent) if you want those functions to fire
- * Make sure you pass the vector from getEvents to m_game's EventQueue
+ * Make sure you pass the object to m_game's addMouseFunctions, and take it out before deleting it
  */
 class MouseEventable {
-private:
-    // close your eyes, there is blood lining the floors of this devil's supermarket
-    // the voice speaker keeps asking more employees to clean up aisle 5
-    // but the ****void&&& just consumes more victims
-
-    /**
-     * this is part of the magic for detection of overridden methods.
-     * this will throw an exception if the type HAS been overridden
-     *      (which gets caught and special things ȟ͗͆á͈̖̞̐̋̀̋̈́̊̍͝p̊̃̉͂p̓̇̋̀͗ę̺̬͕̰͖͓́̃͗̅̔̓̌ň̆̀̚͡)
-    */
-    struct OverrideTest {
-        operator QMouseEvent*() const{throw true;}
-    };
-    virtual void mouseClickEvent(OverrideTest) {}
-    virtual void mouseMoveEvent(OverrideTest) {}
-    virtual void mouseReleaseEvent(OverrideTest) {}
+public:
+    // the kinds of events that can be handled (i.e. onMouseClick, etc etc)
+    enum EVENTS { MouseClickFn, MouseRelFn, MouseMoveFn, EventCount };
+    // everyone that handles one kind of event
+    typedef std::vector<MouseEventable*> EventQueue;
+    // one queue per kind of event, so we only ever walk the ones that care
+    typedef std::array<EventQueue, EventCount> EventQueues;
 
-    virtual void mouseClickEvent(QMouseEvent*) {}
-    virtual void mouseMoveEvent(QMouseEvent*) {}
-    virtual void mouseReleaseEvent(QMouseEvent*) {}
+    virtual ~MouseEventable() {}
 
-public:
-    typedef std::function<void(QMouseEvent*)> MouseFn;
-    // store all the functions that can be called on event happenings (i.e. onMouseClick, etc etc)
-    enum EVENTS { MouseClickFn, MouseRelFn, MouseMoveFn };
-    typedef std::pair<MouseEventable::MouseFn, MouseEventable::EVENTS> EventHook;
-    typedef std::vector<std::weak_ptr<EventHook>> EventQueue;
+    /**
+     * @brief handles - whether this overrides the handler for the event type
+     * @param t - the event type
+     */
+    bool handles(EVENTS t) const { return m_handled & (1 << t); }
 
     /**
-     * @brief getEvents
-     * @return all event functions that can be invoked
+     * @brief dispatch - forward the event on to the matching handler
+     * @param t - the event type
+     * @param e - the event
      */
-    virtual EventQueue getEvents() {
-        MouseEventable::EventQueue retV;
-        for(size_t i = 0; i < m_ownedFns.size();++i) {
-            retV.push_back(m_ownedFns[i]);
+    void dispatch(EVENTS t, QMouseEvent* e) {
+        switch (t) {
+        case MouseClickFn: mouseClickEvent(e); break;
+        case MouseRelFn: mouseReleaseEvent(e); break;
+        case MouseMoveFn: mouseMoveEvent(e); break;
+        default: break;
         }
-        return retV;
     }
-protected:
-    std::vector<std::shared_ptr<EventHook>> m_ownedFns;
 
 protected:
+    // the default functions are empty, and shouldn't be seen
+    virtual void mouseClickEvent(QMouseEvent*) {}
+    virtual void mouseMoveEvent(QMouseEvent*) {}
+    virtual void mouseReleaseEvent(QMouseEvent*) {}
+
     /**
      * This ctor takes a MouseEventable subclass, so that we can register the functions that may or may not have been overridden
-     *  We perform some magic, just to make it add the functions that have been overridden
-     *  as the default functions are empty, and shouldn't be seen
+     *  if T never overrode a handler, &T::handler is still the one declared on MouseEventable, so we can tell at compile time
      * @param child - a pointer to a type that MUST inherit MouseEventable
      */
     template <typename T>
-    MouseEventable(T child){
-        // enforce that we can only construct with MouseEventable types - this will probably throw an error including this line somewhere
-        Q_UNUSED(static_cast<MouseEventable*>(child));
-
-        try{child->mouseClickEvent(OverrideTest());}
-        catch(bool){
-            m_ownedFns.push_back(std::shared_ptr<EventHook>(new EventHook(
-                std::function<void(QMouseEvent*)>([&](QMouseEvent*e) {this->mouseClickEvent(e);}), MouseClickFn)));
-        }
+    MouseEventable(T* child) : m_handled(overridden<T>()) {
+        static_assert(std::is_base_of<MouseEventable, T>::value, "MouseEventable must be constructed with a subclass");
+        Q_UNUSED(child);
+    }
 
-        try{child->mouseMoveEvent(OverrideTest());}
-        catch(bool){
-            m_ownedFns.push_back(std::shared_ptr<EventHook>(new EventHook(
-                std::function<void(QMouseEvent*)>([&](QMouseEvent*e) {this->mouseMoveEvent(e);}), MouseMoveFn)));
-        }
+private:
+    typedef void (MouseEventable::*Handler)(QMouseEvent*);
+    // bitmask of the EVENTS that were overridden
+    int m_handled;
 
-        try{child->mouseReleaseEvent(OverrideTest());}
-        catch(bool){
-            m_ownedFns.push_back(std::shared_ptr<EventHook>(new EventHook(
-                std::function<void(QMouseEvent*)>([&](QMouseEvent*e) {this->mouseReleaseEvent(e);}), MouseRelFn)));
-        }
+    template <typename T>
+    static constexpr int overridden() {
+        return (std::is_same<decltype(&T::mouseClickEvent), Handler>::value ? 0 : 1 << MouseClickFn)
+             | (std::is_same<decltype(&T::mouseReleaseEvent), Handler>::value ? 0 : 1 << MouseRelFn)
+             | (std::is_same<decltype(&T::mouseMoveEvent), Handler>::value ? 0 : 1 << MouseMoveFn);
     }
-
 };
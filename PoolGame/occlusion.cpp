@@ -0,0 +1,119 @@
+#include "occlusion.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+constexpr unsigned CircleGrid::End;
+
+size_t CircleSet::segmentHits(const Vector &v, const Vector &w, Real clearance, std::vector<unsigned char> &mask) const {
+    const size_t n = size();
+    mask.resize(n);
+    const Real* xs = m_x.data();
+    const Real* ys = m_y.data();
+    const Real* rs = m_radius.data();
+    unsigned char* out = mask.data();
+
+    // Obtained from https://stackoverflow.com/a/1501725, with the segment's parts hoisted out of the loop
+    const Real dx = w.x - v.x;
+    const Real dy = w.y - v.y;
+    const Real l2 = dx*dx + dy*dy;
+    // v == w case, every projection is just v
+    const Real invL2 = l2 > 0 ? Real(1) / l2 : Real(0);
+
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Real px = xs[i] - v.x;
+        const Real py = ys[i] - v.y;
+        // project the centre onto the segment, clamped to its ends
+        const Real t = std::min(Real(1), std::max(Real(0), (px*dx + py*dy) * invL2));
+        const Real ex = px - t*dx;
+        const Real ey = py - t*dy;
+        const Real reach = rs[i] + clearance;
+        out[i] = (reach >= 0) & (ex*ex + ey*ey <= reach*reach);
+        hits += out[i];
+    }
+    return hits;
+}
+
+size_t CircleSet::circleHits(const Vector &centre, Real radius, std::vector<unsigned char> &mask) const {
+    const size_t n = size();
+    mask.resize(n);
+    const Real* xs = m_x.data();
+    const Real* ys = m_y.data();
+    const Real* rs = m_radius.data();
+    unsigned char* out = mask.data();
+
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Real ex = xs[i] - centre.x;
+        const Real ey = ys[i] - centre.y;
+        const Real reach = rs[i] + radius;
+        out[i] = ex*ex + ey*ey < reach*reach;
+        hits += out[i];
+    }
+    return hits;
+}
+
+void CircleGrid::reset(Real width, Real height, Real cellSize) {
+    if (!(cellSize > 0)) throw std::invalid_argument("the cells of a grid need a size");
+    m_cellSize = cellSize;
+    m_columns = std::max(1, int(std::ceil(width / cellSize)));
+    m_rows = std::max(1, int(std::ceil(height / cellSize)));
+    m_maxRadius = 0;
+    m_centres.clear();
+    m_radii.clear();
+    m_next.clear();
+    m_heads.assign(size_t(m_columns) * m_rows, End);
+}
+
+int CircleGrid::column(Real x) const {
+    return std::min(m_columns - 1, std::max(0, int(std::floor(x / m_cellSize))));
+}
+
+int CircleGrid::row(Real y) const {
+    return std::min(m_rows - 1, std::max(0, int(std::floor(y / m_cellSize))));
+}
+
+size_t CircleGrid::add(const Vector &centre, Real radius) {
+    const size_t i = m_centres.size();
+    m_centres.push_back(centre);
+    m_radii.push_back(radius);
+    m_maxRadius = std::max(m_maxRadius, radius);
+    // goes on the front of its cell's list
+    unsigned& head = m_heads[size_t(row(centre.y)) * m_columns + column(centre.x)];
+    m_next.push_back(head);
+    head = unsigned(i);
+    return i;
+}
+
+bool CircleGrid::overlaps(const Vector &centre, Real radius) const {
+    // any circle we could overlap has its centre within this reach of ours
+    const Real reach = radius + m_maxRadius;
+    const int right = column(centre.x + reach), bottom = row(centre.y + reach);
+    for (int r = row(centre.y - reach); r <= bottom; ++r) {
+        for (int c = column(centre.x - reach); c <= right; ++c) {
+            for (unsigned i = m_heads[size_t(r) * m_columns + c]; i != End; i = m_next[i]) {
+                const Vector d = m_centres[i] - centre;
+                const Real sum = m_radii[i] + radius;
+                if (d.lengthSquared() < sum * sum) return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CircleGrid::within(const Vector &min, const Vector &max, std::vector<unsigned> &out) const {
+    out.clear();
+    const int right = column(max.x + m_maxRadius), bottom = row(max.y + m_maxRadius);
+    for (int r = row(min.y - m_maxRadius); r <= bottom; ++r) {
+        for (int c = column(min.x - m_maxRadius); c <= right; ++c) {
+            for (unsigned i = m_heads[size_t(r) * m_columns + c]; i != End; i = m_next[i]) {
+                const Vector& p = m_centres[i];
+                const Real reach = m_radii[i];
+                if (p.x + reach >= min.x && p.x - reach <= max.x && p.y + reach >= min.y && p.y - reach <= max.y) out.push_back(i);
+            }
+        }
+    }
+    // cells are visited out of order, so put them back in order (i.e. to draw them in order)
+    std::sort(out.begin(), out.end());
+}
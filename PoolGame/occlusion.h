@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include "physics.h"
+
+/**
+ * @brief The CircleSet class
+ * Circles stored as separate x, y & radius arrays, so one segment or circle can be tested against
+ *  all of them in a single branch-free loop (that the compiler can vectorize), rather than one
+ *  QVector2D at a time. The result is a mask with a byte per circle, in the order they were added.
+ */
+class CircleSet {
+    std::vector<Real> m_x;
+    std::vector<Real> m_y;
+    std::vector<Real> m_radius;
+public:
+    void clear() { m_x.clear(); m_y.clear(); m_radius.clear(); }
+    void reserve(size_t n) { m_x.reserve(n); m_y.reserve(n); m_radius.reserve(n); }
+    void add(const Vector& centre, Real radius) {
+        m_x.push_back(centre.x);
+        m_y.push_back(centre.y);
+        m_radius.push_back(radius);
+    }
+    size_t size() const { return m_x.size(); }
+
+    /**
+     * @brief segmentHits - which circles come within reach of the segment vw,
+     *  i.e. the distance from the segment to their centre is <= their radius + clearance
+     * @param v - start of the segment
+     * @param w - end of the segment
+     * @param clearance - added to every radius, can be negative (i.e. a ball fully inside a pocket)
+     * @param mask - resized to size(), 1 for each circle that is hit, 0 otherwise
+     * @return how many circles were hit
+     */
+    size_t segmentHits(const Vector& v, const Vector& w, Real clearance, std::vector<unsigned char>& mask) const;
+
+    /**
+     * @brief circleHits - which circles overlap the circle, i.e. their centres are closer than the sum of the radii
+     * @param centre - centre of the circle
+     * @param radius - radius of the circle
+     * @param mask - resized to size(), 1 for each circle that overlaps, 0 otherwise
+     * @return how many circles overlap
+     */
+    size_t circleHits(const Vector& centre, Real radius, std::vector<unsigned char>& mask) const;
+};
+
+/**
+ * @brief The CircleGrid class
+ * A free-space index of circles, bucketed into a uniform grid over the table. Testing whether a new circle
+ *  fits only looks at the few cells around it, so filling a table takes time linear in the number of circles
+ *  rather than quadratic.
+ */
+class CircleGrid {
+    Real m_cellSize = 1;
+    int m_columns = 0;
+    int m_rows = 0;
+    // the largest radius added, how far outside a circle's own cell it can reach
+    Real m_maxRadius = 0;
+    std::vector<Vector> m_centres;
+    std::vector<Real> m_radii;
+    // the circles whose centre lies in each cell, as a linked list: the first one in each cell (row by row),
+    //  and the next one in the same cell as each circle. flat, so circles moving to other cells never allocate
+    std::vector<unsigned> m_heads;
+    std::vector<unsigned> m_next;
+    // the end of a cell's list
+    static constexpr unsigned End = ~0u;
+
+    /* the cell the point falls in, clamped to the grid */
+    int column(Real x) const;
+    int row(Real y) const;
+public:
+    /**
+     * @param width - the width of the area covered
+     * @param height - the height of the area covered
+     * @param cellSize - the width & height of a cell, around the diameter of the usual circle is best
+     */
+    CircleGrid(Real width, Real height, Real cellSize) { reset(width, height, cellSize); }
+    CircleGrid() {}
+
+    /**
+     * @brief reset - forget every circle, and cover a (possibly) different area.
+     *  Holds on to its memory, so it can be rebuilt every frame without allocating (until it holds more circles, or cells, than ever before)
+     */
+    void reset(Real width, Real height, Real cellSize);
+
+    /**
+     * @brief add - index the circle
+     * @return its index
+     */
+    size_t add(const Vector& centre, Real radius);
+    size_t size() const { return m_centres.size(); }
+    const Vector& centre(size_t i) const { return m_centres[i]; }
+    Real radius(size_t i) const { return m_radii[i]; }
+
+    /**
+     * @brief overlaps - whether the circle overlaps any of the circles, i.e. the centres are closer than the sum of the radii
+     * @param centre - centre of the circle
+     * @param radius - radius of the circle
+     */
+    bool overlaps(const Vector& centre, Real radius) const;
+
+    /**
+     * @brief within - which circles (might) reach into the rectangle, i.e. their bounding boxes overlap it
+     * @param min - the rectangle's top left
+     * @param max - the rectangle's bottom right
+     * @param out - cleared, then filled with the indices of the circles, in the order they were added
+     */
+    void within(const Vector& min, const Vector& max, std::vector<unsigned>& out) const;
+};
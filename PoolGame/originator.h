@@ -14,6 +14,11 @@ public:
      */
     Game* getGame(){return m_game;}
 
+    /**
+     * @brief setGame - the game was replaced (i.e. by seeking the timeline), so save that one from now on
+     */
+    void setGame(Game* game){m_game = game;}
+
     /**
      * @return a memento with current game
      */
@@ -25,6 +30,21 @@ public:
      */
     void restore(Memento* memento){m_game = memento->getGame();}
 
+    /**
+     * @return a memento of the given game (i.e. one read from a checkpoint)
+     */
+    Memento* createMomento(Game* game){return new Memento(game);}
+
+    /**
+     * @return the game saved in the memento, without restoring it (i.e. to write it to a checkpoint)
+     */
+    Game* peek(Memento* memento){return memento->getGame();}
+
+    /**
+     * @brief discard - delete a memento that will never be restored, along with its game
+     */
+    void discard(Memento* memento){delete memento->getGame(); delete memento;}
+
 private:
     Game* m_game;
 };
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QVector2D>
+#include <cmath>
+#include <utility>
+
+/**
+ * The precision of the physics. The default build keeps every position, velocity & mass in single
+ *  precision, so nothing is converted during a step and the ball data packs into vector lanes.
+ *  Building with CONFIG+=accurate makes all of it double precision, for long sessions where drift matters.
+ */
+#ifdef POOLGAME_ACCURATE
+typedef double Real;
+#else
+typedef float Real;
+#endif
+
+/**
+ * @brief The Vec2 struct
+ * A 2d vector of any precision. QVector2D is always float, so it's only used at the edges (rendering, input)
+ */
+template <typename T>
+struct Vec2 {
+    T x = 0;
+    T y = 0;
+
+    Vec2() {}
+    Vec2(T x, T y) : x(x), y(y) {}
+    explicit Vec2(const QVector2D& v) : x(v.x()), y(v.y()) {}
+    template <typename U>
+    explicit Vec2(const Vec2<U>& v) : x(T(v.x)), y(T(v.y)) {}
+
+    QVector2D toQVector2D() const { return QVector2D(x, y); }
+
+    Vec2 operator+(const Vec2& o) const { return Vec2(x + o.x, y + o.y); }
+    Vec2 operator-(const Vec2& o) const { return Vec2(x - o.x, y - o.y); }
+    Vec2 operator-() const { return Vec2(-x, -y); }
+    Vec2 operator*(T s) const { return Vec2(x * s, y * s); }
+    // componentwise, like QVector2D
+    Vec2 operator*(const Vec2& o) const { return Vec2(x * o.x, y * o.y); }
+    Vec2 operator/(T s) const { return Vec2(x / s, y / s); }
+    Vec2& operator+=(const Vec2& o) { x += o.x; y += o.y; return *this; }
+    Vec2& operator-=(const Vec2& o) { x -= o.x; y -= o.y; return *this; }
+    Vec2& operator*=(const Vec2& o) { x *= o.x; y *= o.y; return *this; }
+    bool operator==(const Vec2& o) const { return x == o.x && y == o.y; }
+    bool operator!=(const Vec2& o) const { return !(*this == o); }
+    friend Vec2 operator*(T s, const Vec2& v) { return v * s; }
+
+    T dot(const Vec2& o) const { return x * o.x + y * o.y; }
+    T lengthSquared() const { return dot(*this); }
+    T length() const { return std::sqrt(lengthSquared()); }
+    bool isNull() const { return x == 0 && y == 0; }
+    /* a unit vector in the same direction, or the null vector if we're null */
+    Vec2 normalized() const {
+        T len = length();
+        return len > 0 ? *this / len : Vec2();
+    }
+};
+
+typedef Vec2<Real> Vector;
+
+/**
+ * @brief The Physics struct
+ * The maths of a step, for a precision T. Everything is static so both precisions can be
+ *  used side by side (see physicscheck)
+ */
+template <typename T>
+struct Physics {
+    typedef Vec2<T> V;
+
+    /**
+     * @brief touching - whether two circles overlap (or touch)
+     */
+    static bool touching(const V& posA, T radiusA, const V& posB, T radiusB) {
+        // squared, so there's no sqrt
+        const T reach = radiusA + radiusB;
+        return !((posB - posA).lengthSquared() > reach * reach);
+    }
+
+    /**
+     * @brief bounce - which components of a ball's velocity should flip, to keep it on the table
+     * @param pos - the ball's position
+     * @param vel - the ball's velocity
+     * @param radius - the ball's radius
+     * @param width - the table's width
+     * @param height - the table's height
+     * @return the multiplier of the velocity, -1 for a component that flips
+     */
+    static V bounce(const V& pos, const V& vel, T radius, T width, T height) {
+        V change(1, 1);
+        // beyond the left side, or the right side, and heading further out
+        if (pos.x - radius <= 0) {
+            if (vel.x <= 0) change.x = -1;
+        } else if (pos.x + radius >= width) {
+            if (vel.x >= 0) change.x = -1;
+        }
+        // beyond the top, or the bottom (we want to let the ball bounce back if its heading back)
+        if (pos.y - radius <= 0) {
+            if (vel.y <= 0) change.y = -1;
+        } else if (pos.y + radius >= height) {
+            if (vel.y >= 0) change.y = -1;
+        }
+        return change;
+    }
+
+    /**
+     * @brief collide - the changes in velocity of two touching balls. SOURCE : ASSIGNMENT SPEC
+     *  The spec solves a quadratic for B's new speed along the line between the centres, pb'. Its discriminant is
+     *  4(pa - pb)^2, so the root it wants is pb' = (2pa + (mr - 1)pb) / (mr + 1) whenever they're closing in
+     *  (pa > pb), and there's nothing to do otherwise. Worked out along the unnormalised line between the centres,
+     *  so there is no sqrt (and no negative discriminant from rounding, which made NaNs in clusters)
+     * @return pair<deltaVelocityA, deltaVelocityB>, both null if they aren't closing in
+     */
+    static std::pair<V, V> collide(const V& posA, const V& velA, T massA, const V& posB, const V& velB, T massB) {
+        const V line = posB - posA;
+        // pa & pb, both scaled by the line's length
+        const T pa = line.dot(velA);
+        const T pb = line.dot(velB);
+        const T lengthSquared = line.lengthSquared();
+        if (pa <= pb || lengthSquared <= 0) return std::make_pair(V(), V());
+
+        const T mr = massB / massA;
+        // pb' - pb, over the line's length (once for the speeds, once more for the line's direction)
+        const T change = 2 * (pa - pb) / ((mr + 1) * lengthSquared);
+        return std::make_pair(line * (-mr * change), line * change);
+    }
+
+    /**
+     * @brief integrate - move a ball along its velocity, and slow it down by the friction
+     */
+    static void integrate(V& pos, V& vel, T friction, T dt) {
+        pos += vel * dt;
+        vel -= vel * (friction * dt);
+    }
+};
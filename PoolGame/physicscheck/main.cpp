@@ -0,0 +1,201 @@
+/**
+ * physicscheck - check the float physics against the double physics. Every part of a step is called on the same
+ *  inputs in both precisions, and the results have to agree to within a relative tolerance. Then the balls of a
+ *  generated scene fly free (without colliding) for a short horizon, and have to stay together just as closely.
+ *  Whole games aren't compared: colliding balls drift apart exponentially in any two precisions, so that would
+ *  only measure the gap between them, not find bugs. Fails if anything disagrees
+ *  e.g. physicscheck --samples 100000 --horizon 100 --tolerance 1e-4
+ */
+
+#include "physics.h"
+#include "scenegenerator.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+typedef Physics<float> Fast;
+typedef Physics<double> Accurate;
+
+/**
+ * @brief The Sampler struct - random inputs, already rounded to float so both precisions start out the same
+ */
+struct Sampler {
+    std::mt19937 rng;
+
+    Sampler(unsigned int seed) : rng(seed) {}
+    double uniform(double min, double max) { return float(std::uniform_real_distribution<double>(min, max)(rng)); }
+    Vec2<double> point(double min, double max) { return Vec2<double>(uniform(min, max), uniform(min, max)); }
+};
+
+/**
+ * @brief The Result struct - how one of the checks went
+ */
+struct Result {
+    const char* name;
+    size_t checked = 0;
+    size_t failed = 0;
+    // the largest error, relative to the size of the inputs
+    double worst = 0;
+
+    Result(const char* name) : name(name) {}
+    void add(double error, double tolerance) {
+        ++checked;
+        worst = std::max(worst, error);
+        if (!(error <= tolerance)) ++failed;
+    }
+    /* for yes or no answers, which have to be the same */
+    void same(bool agree) { add(agree ? 0 : 1, 0); }
+};
+
+/* how far apart the results are, as a fraction of the scale of what went in */
+static double relative(const Vec2<float>& fast, const Vec2<double>& accurate, double scale) {
+    return (Vec2<double>(fast) - accurate).length() / std::max(scale, 1e-30);
+}
+
+/**
+ * @brief checkCollide - the changes in velocity of touching (or nearly touching) balls
+ */
+static void checkCollide(Sampler& s, Result& r, size_t samples, double speed, double tolerance) {
+    for (size_t i = 0; i < samples; ++i) {
+        const double radiusA = s.uniform(5, 30), radiusB = s.uniform(5, 30);
+        const Vec2<double> posA = s.point(0, 1000);
+        const Vec2<double> posB = posA + s.point(-1, 1).normalized() * float((radiusA + radiusB) * s.uniform(0.5, 1));
+        const Vec2<double> posBf = Vec2<double>(Vec2<float>(posB));
+        const Vec2<double> velA = s.point(-speed, speed), velB = s.point(-speed, speed);
+        const double massA = s.uniform(0.5, 10), massB = s.uniform(0.5, 10);
+
+        const auto fast = Fast::collide(Vec2<float>(posA), Vec2<float>(velA), massA, Vec2<float>(posBf), Vec2<float>(velB), massB);
+        const auto accurate = Accurate::collide(posA, velA, massA, posBf, velB, massB);
+        // a ball can gain as much as twice the other's speed, so that's the scale of any error
+        const double scale = velA.length() + velB.length();
+        r.add(std::max(relative(fast.first, accurate.first, scale), relative(fast.second, accurate.second, scale)), tolerance);
+    }
+}
+
+/**
+ * @brief checkTouching - whether balls overlap, away from where they only just touch
+ */
+static void checkTouching(Sampler& s, Result& r, size_t samples) {
+    for (size_t i = 0; i < samples; ++i) {
+        const double radiusA = s.uniform(5, 30), radiusB = s.uniform(5, 30);
+        const Vec2<double> posA = s.point(0, 1000);
+        const Vec2<double> posB = Vec2<double>(Vec2<float>(posA + s.point(-2, 2) * float(radiusA + radiusB)));
+        // only just touching is down to rounding in either
+        const double reach = radiusA + radiusB;
+        if (std::abs((posB - posA).length() - reach) < 1e-4 * reach) continue;
+        r.same(Fast::touching(Vec2<float>(posA), radiusA, Vec2<float>(posB), radiusB)
+               == Accurate::touching(posA, radiusA, posB, radiusB));
+    }
+}
+
+/**
+ * @brief checkBounce - which way balls bounce off the table, away from where they only just reach its edges
+ */
+static void checkBounce(Sampler& s, Result& r, size_t samples, double speed) {
+    const double width = 1000, height = 500, margin = 1e-3;
+    for (size_t i = 0; i < samples; ++i) {
+        const double radius = s.uniform(5, 30);
+        const Vec2<double> pos(s.uniform(-50, width + 50), s.uniform(-50, height + 50));
+        const Vec2<double> vel = s.point(-speed, speed);
+        if (std::abs(pos.x - radius) < margin || std::abs(pos.x + radius - width) < margin
+                || std::abs(pos.y - radius) < margin || std::abs(pos.y + radius - height) < margin) continue;
+        r.same(Vec2<double>(Fast::bounce(Vec2<float>(pos), Vec2<float>(vel), radius, width, height))
+               == Accurate::bounce(pos, vel, radius, width, height));
+    }
+}
+
+/**
+ * @brief checkIntegrate - a single step of moving & slowing down
+ */
+static void checkIntegrate(Sampler& s, Result& r, size_t samples, double speed, double tolerance) {
+    for (size_t i = 0; i < samples; ++i) {
+        Vec2<double> pos = s.point(0, 1000), vel = s.point(-speed, speed);
+        const double friction = s.uniform(0, 1), dt = s.uniform(0.001, 0.1);
+        Vec2<float> fastPos(pos), fastVel(vel);
+        const double scale = pos.length() + vel.length() * dt;
+        Fast::integrate(fastPos, fastVel, friction, dt);
+        Accurate::integrate(pos, vel, friction, dt);
+        r.add(std::max(relative(fastPos, pos, scale), relative(fastVel, vel, vel.length())), tolerance);
+    }
+}
+
+/**
+ * @brief checkFreeFlight - the balls of a generated scene, moving on their own for a few steps.
+ *  This is where errors would add up, if they did
+ */
+static void checkFreeFlight(const QJsonObject& conf, Result& r, int horizon, double tolerance) {
+    const double friction = conf.value("table").toObject().value("friction").toDouble();
+    const double dt = 0.1;
+    for (const auto& item : conf.value("balls").toArray()) {
+        QJsonObject b = item.toObject();
+        QJsonObject p = b.value("position").toObject(), v = b.value("velocity").toObject();
+        Vec2<float> fastPos(p.value("x").toDouble(), p.value("y").toDouble());
+        Vec2<float> fastVel(v.value("x").toDouble(), v.value("y").toDouble());
+        Vec2<double> pos(fastPos), vel(fastVel);
+        // the furthest it could have gone, as the scale of any error
+        const double scale = pos.length() + vel.length() * dt * horizon;
+        double worst = 0;
+        for (int s = 0; s < horizon; ++s) {
+            Fast::integrate(fastPos, fastVel, friction, dt);
+            Accurate::integrate(pos, vel, friction, dt);
+            worst = std::max(worst, relative(fastPos, pos, scale));
+        }
+        r.add(worst, tolerance);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("physicscheck");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Check the float physics against the double physics");
+    parser.addHelpOption();
+    QCommandLineOption samplesOpt("samples", "Random inputs to try each part of a step on", "count", "100000");
+    QCommandLineOption ballsOpt("balls", "Number of balls flying free", "count", "100");
+    QCommandLineOption speedOpt("speed", "Most speed of the balls", "speed", "300");
+    QCommandLineOption horizonOpt("horizon", "Steps the balls fly free for", "steps", "100");
+    QCommandLineOption seedOpt("seed", "Random seed", "seed", "1");
+    QCommandLineOption toleranceOpt("tolerance", "Largest allowed error, relative to the size of the inputs", "fraction", "1e-4");
+    parser.addOptions({samplesOpt, ballsOpt, speedOpt, horizonOpt, seedOpt, toleranceOpt});
+    parser.process(app);
+
+    const size_t samples = parser.value(samplesOpt).toUInt();
+    const double speed = parser.value(speedOpt).toDouble();
+    const int horizon = parser.value(horizonOpt).toInt();
+    const double tolerance = parser.value(toleranceOpt).toDouble();
+    if (samples == 0 || horizon <= 0 || !(speed > 0) || !(tolerance > 0)) {
+        std::cerr << "invalid arguments\n";
+        parser.showHelp(1);
+    }
+
+    SceneParameters params;
+    params.ballCount = parser.value(ballsOpt).toInt();
+    params.maxSpeed = speed;
+    params.seed = parser.value(seedOpt).toUInt();
+    params.depth = 0;
+    params.pockets = SceneParameters::NoPockets;
+
+    Sampler sampler(params.seed);
+    Result results[] = {Result("collide"), Result("touching"), Result("bounce"), Result("integrate"), Result("freeFlight")};
+    checkCollide(sampler, results[0], samples, speed, tolerance);
+    checkTouching(sampler, results[1], samples);
+    checkBounce(sampler, results[2], samples, speed);
+    checkIntegrate(sampler, results[3], samples, speed, tolerance);
+    checkFreeFlight(SceneGenerator(params).generate(), results[4], horizon, tolerance);
+
+    bool passed = true;
+    std::cout << "{";
+    for (const Result& r : results) {
+        std::cout << (&r == results ? "" : ", ") << "\"" << r.name << "\": {\"checked\": " << r.checked
+                  << ", \"failed\": " << r.failed << ", \"worstError\": " << r.worst << "}";
+        passed = passed && r.failed == 0 && r.checked > 0;
+    }
+    std::cout << ", \"tolerance\": " << tolerance << ", \"passed\": " << (passed ? "true" : "false") << "}" << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Checks the single precision physics against the double precision physics
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = physicscheck
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+# a test, so make check builds it and runs it
+CONFIG += testcase
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        main.cpp \
+    ../scenegenerator.cpp
+
+HEADERS += \
+    ../physics.h \
+    ../scenegenerator.h
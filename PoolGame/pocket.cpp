@@ -11,7 +11,7 @@ double Pocket::radius() const
     return m_radius;
 }
 
-void Pocket::render(QPainter &painter, const QVector2D &offset) {
+void Pocket::render(QPainter &painter, const QVector2D &offset) const {
     
     QVector2D absolutePos = offset + m_pos;
 
@@ -19,11 +19,10 @@ void Pocket::render(QPainter &painter, const QVector2D &offset) {
     painter.drawEllipse(absolutePos.toPointF(), m_radius, m_radius);
 
     // draw a cute little text indicating how many balls sunk
-    std::string numSunkStr = std::to_string(m_sunk);
     QPen oldPen = painter.pen();
-    painter.setPen(QColor("white"));
+    painter.setPen(m_textPen);
     QRectF tRect((absolutePos - QVector2D(m_radius, m_radius)).toPointF(), QSizeF(2*m_radius, 2*m_radius));
-    painter.drawText(tRect, Qt::AlignCenter, QString(numSunkStr.c_str()));
+    painter.drawText(tRect, Qt::AlignCenter, m_sunkText);
 
     painter.setPen(oldPen);
 }
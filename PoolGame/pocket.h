@@ -13,16 +13,20 @@ class Pocket
     QBrush m_pocketBrush = QBrush(QColor("black"));
 
     size_t m_sunk = 0;
+    // what's drawn on us, only remade when the count changes
+    QString m_sunkText = QString("0");
+    QPen m_textPen = QPen(QColor("white"));
 public:
     Pocket(double radius, QVector2D pos) : m_radius(radius), m_pos(pos) {}
-    Pocket(Pocket& pocket):m_radius(pocket.m_radius), m_pos(pocket.m_pos), m_sunk(pocket.m_sunk) {}
+    Pocket(Pocket& pocket):m_radius(pocket.m_radius), m_pos(pocket.m_pos), m_sunk(pocket.m_sunk),
+        m_sunkText(pocket.m_sunkText) {}
     /**
      * @brief render - draw the pocket to the screen with the provided brush and offset
      * @param painter - the brush to paint with
      * @param offset - the offset from the window
      */
 
-    void render(QPainter& painter, const QVector2D& offset);
+    void render(QPainter& painter, const QVector2D& offset) const;
 
     /// whether this pocket contains the circle defined by the arguments
     bool contains(const QVector2D& center, const double& radius) {
@@ -30,7 +34,13 @@ public:
     }
 
     /** add whether this pocket has sunk a ball */
-    void incrementSunk() { ++m_sunk; }
+    void incrementSunk() { setSunk(m_sunk + 1); }
+    /* how many balls this pocket has sunk */
+    size_t getSunk() const { return m_sunk; }
+    void setSunk(size_t sunk) {
+        m_sunk = sunk;
+        m_sunkText = QString::number(qulonglong(sunk));
+    }
     QVector2D pos() const;
     void revertColour(){m_pocketBrush.setColor(QColor("black"));}
     void changeColour(){m_pocketBrush.setColor(QColor("blue"));}
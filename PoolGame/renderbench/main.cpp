@@ -0,0 +1,186 @@
+/**
+ * renderbench - draw generated scenes into an offscreen image, and time each part of a frame.
+ *  Runs without a window (on the offscreen platform), e.g.
+ *  renderbench --balls 100,1000,5000 --depth 2 --frames 50 results.json
+ */
+
+#include "scenegenerator.h"
+#include "gamebuilder.h"
+#include "stagetwobuilder.h"
+#include "utils.h"
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+#include <iostream>
+
+/* the parts of a frame that are timed apart */
+enum Category { TableTime, BallTime, ChildTime, ParticleTime, AidTime, CategoryCount };
+static const char* categoryNames[CategoryCount] = {"table", "balls", "children", "particles", "aid"};
+
+/**
+ * @brief timeLayer - draw a layer of the game
+ * @return how long it took, in nanoseconds
+ */
+static qint64 timeLayer(const Game& game, QPainter& painter, Game::RenderLayer layer, std::vector<unsigned>& visible) {
+    QElapsedTimer timer;
+    timer.start();
+    game.renderLayer(painter, layer, QRectF(), visible);
+    return timer.nsecsElapsed();
+}
+
+/**
+ * @brief bench - time drawing a scene
+ * @param params - the scene
+ * @param antialiasing - whether to draw with antialiasing
+ * @param frames - how many frames to time
+ * @param warmup - how many steps to simulate first, so there are particles to draw
+ * @return the results, times are the mean per frame in milliseconds
+ */
+static QJsonObject bench(const SceneParameters& params, bool antialiasing, int frames, int warmup) {
+    SceneGenerator generator(params);
+    QJsonObject conf = generator.generate();
+    GameDirector director(&conf);
+    director.setBuilder(new StageTwoBuilder());
+    Game* game = director.createGame();
+    StageTwoBuilder::decorate(*game);
+    // with the aid showing, so that gets timed too
+    game->setStageThree();
+    game->switchMode();
+    game->seed(params.seed);
+    for (int i = 0; i < warmup; ++i) game->animate(1.0/(double)animFrameMS);
+
+    QImage image(params.tableWidth, params.tableHeight, QImage::Format_ARGB32_Premultiplied);
+    RenderQuality quality;
+    quality.antialiasing = antialiasing;
+    std::vector<unsigned> visible;
+    qint64 totals[CategoryCount] = {};
+    qint64 fastest = std::numeric_limits<qint64>::max(), slowest = 0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        qint64 times[CategoryCount] = {};
+
+        times[TableTime] = timeLayer(*game, painter, Game::TableLayer, visible);
+        // the balls on their own, then again with their children. the difference is what the children cost
+        quality.renderChildren = false;
+        game->setQuality(quality);
+        game->prepareRender(QRectF());
+        times[BallTime] = timeLayer(*game, painter, Game::BallLayer, visible);
+        quality.renderChildren = true;
+        game->setQuality(quality);
+        game->prepareRender(QRectF());
+        times[ChildTime] = std::max<qint64>(0, timeLayer(*game, painter, Game::BallLayer, visible) - times[BallTime]);
+        times[ParticleTime] = timeLayer(*game, painter, Game::EffectLayer, visible);
+        times[AidTime] = timeLayer(*game, painter, Game::AidLayer, visible);
+
+        qint64 frameTime = 0;
+        for (int c = 0; c < CategoryCount; ++c) {
+            totals[c] += times[c];
+            frameTime += times[c];
+        }
+        fastest = std::min(fastest, frameTime);
+        slowest = std::max(slowest, frameTime);
+    }
+
+    QJsonObject ms;
+    qint64 total = 0;
+    for (int c = 0; c < CategoryCount; ++c) {
+        ms[categoryNames[c]] = totals[c] / 1e6 / frames;
+        total += totals[c];
+    }
+    ms["frame"] = total / 1e6 / frames;
+    ms["fastestFrame"] = fastest / 1e6;
+    ms["slowestFrame"] = slowest / 1e6;
+
+    QJsonObject result;
+    result["balls"] = params.ballCount;
+    result["placed"] = generator.placed();
+    result["onTable"] = int(game->getBalls().size());
+    result["particles"] = int(game->getParticleCount());
+    result["antialiasing"] = antialiasing;
+    result["ms"] = ms;
+    delete game;
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // no window is ever shown, so don't need a display either
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("renderbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Time drawing generated pool scenes, without a window");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Where to write the json results (stdout if omitted)");
+    QCommandLineOption ballsOpt("balls", "Ball counts to sweep, comma separated", "counts", "100,1000,5000");
+    QCommandLineOption aaOpt("antialiasing", "Antialiasing to sweep: on, off or both", "mode", "both");
+    QCommandLineOption depthOpt("depth", "Levels of nested balls", "levels", "2");
+    QCommandLineOption speedOpt("speed", "Most initial speed of non-cue balls", "speed", "300");
+    QCommandLineOption tableOpt("table", "Table size", "WxH", "4000x2000");
+    QCommandLineOption framesOpt("frames", "Frames to time per scene", "count", "50");
+    QCommandLineOption warmupOpt("warmup", "Steps to simulate before timing (for particles)", "steps", "30");
+    QCommandLineOption seedOpt("seed", "Random seed", "seed", "1");
+    parser.addOptions({ballsOpt, aaOpt, depthOpt, speedOpt, tableOpt, framesOpt, warmupOpt, seedOpt});
+    parser.process(app);
+
+    SceneParameters params;
+    QStringList table = parser.value(tableOpt).split("x");
+    const QString aa = parser.value(aaOpt);
+    const int frames = parser.value(framesOpt).toInt();
+    const int warmup = parser.value(warmupOpt).toInt();
+    std::vector<int> counts;
+    bool ok = table.size() == 2 && (aa == "on" || aa == "off" || aa == "both") && frames > 0 && warmup >= 0;
+    for (const QString& count : parser.value(ballsOpt).split(",")) {
+        bool valid = false;
+        counts.push_back(count.toInt(&valid));
+        ok = ok && valid && counts.back() > 0;
+    }
+    if (ok) {
+        params.tableWidth = table.at(0).toInt();
+        params.tableHeight = table.at(1).toInt();
+    }
+    params.depth = parser.value(depthOpt).toInt();
+    params.maxSpeed = parser.value(speedOpt).toDouble();
+    params.seed = parser.value(seedOpt).toUInt();
+    if (!ok || params.tableWidth <= 0 || params.tableHeight <= 0) {
+        std::cerr << "invalid arguments\n";
+        parser.showHelp(1);
+    }
+
+    QJsonArray results;
+    for (int count : counts) {
+        params.ballCount = count;
+        if (aa != "off") results.append(bench(params, true, frames, warmup));
+        if (aa != "on") results.append(bench(params, false, frames, warmup));
+        std::cerr << "benched " << count << " balls\n";
+    }
+
+    QJsonObject report;
+    report["frames"] = frames;
+    report["warmup"] = warmup;
+    report["table"] = parser.value(tableOpt);
+    report["depth"] = params.depth;
+    report["seed"] = int(params.seed);
+    report["results"] = results;
+
+    QByteArray json = QJsonDocument(report).toJson();
+    const QStringList outputs = parser.positionalArguments();
+    QFile out;
+    bool opened = outputs.isEmpty() ? out.open(stdout, QIODevice::WriteOnly)
+                                    : (out.setFileName(outputs.at(0)), out.open(QIODevice::WriteOnly));
+    if (!opened || out.write(json) != json.size()) {
+        std::cerr << "unable to write the results\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#-------------------------------------------------
+#
+# Headless render benchmark, built from the game's sources
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+TARGET = renderbench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        main.cpp \
+    ../scenegenerator.cpp \
+    ../ball.cpp \
+    ../ballbehaviours.cpp \
+    ../table.cpp \
+    ../pocket.cpp \
+    ../game.cpp \
+    ../gamebuilder.cpp \
+    ../stageonefactory.cpp \
+    ../stagetwofactory.cpp \
+    ../stagetwobuilder.cpp \
+    ../strategy.cpp \
+    ../visiter.cpp \
+    ../occlusion.cpp \
+    ../eventstream.cpp \
+    ../contactcache.cpp
+
+HEADERS += \
+    ../scenegenerator.h \
+    ../game.h
@@ -0,0 +1,295 @@
+#include "scenariocache.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+#include <QBuffer>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+constexpr char ScenarioCache::Magic[4];
+constexpr char ScenarioCache::CheckpointMagic[4];
+
+QByteArray ScenarioCache::hash(const QByteArray &json) {
+    return QCryptographicHash::hash(json, QCryptographicHash::Sha1);
+}
+
+QByteArray ScenarioCache::hash(QIODevice *device) {
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    hasher.addData(device);
+    return hasher.result();
+}
+
+Game* ScenarioCache::load(const QString &path, const QByteArray &hash) {
+    std::vector<Game*> games;
+    // stale or otherwise unusable, so the config will need to be built the slow way
+    if (!readFile(path, Magic, hash, games)) return nullptr;
+    if (games.size() != 1) {
+        for (Game* g : games) delete g;
+        return nullptr;
+    }
+    return games.front();
+}
+
+bool ScenarioCache::save(const QString &path, const QByteArray &hash, Game &game, quint32 flags) {
+    return writeFile(path, Magic, hash, std::vector<Game*>{&game}, flags | StageTwo);
+}
+
+Game* ScenarioCache::loadCheckpoint(const QString &path, std::vector<Game *> &history) {
+    std::vector<Game*> games;
+    if (!readFile(path, CheckpointMagic, QByteArray(sizeof(Header::hash), '\0'), games)) {
+        std::cerr << "unable to load checkpoint " << path.toStdString() << std::endl;
+        return nullptr;
+    }
+    // the game being played goes last, after its history
+    Game* game = games.back();
+    games.pop_back();
+    history = games;
+    return game;
+}
+
+bool ScenarioCache::saveCheckpoint(const QString &path, Game &game, const std::vector<Game *> &history) {
+    std::vector<Game*> games(history);
+    games.push_back(&game);
+    return writeFile(path, CheckpointMagic, QByteArray(sizeof(Header::hash), '\0'), games, 0);
+}
+
+QByteArray ScenarioCache::snapshot(Game &game) {
+    QByteArray records;
+    QBuffer buffer(&records);
+    buffer.open(QIODevice::WriteOnly);
+    writeGame(buffer, game, 0);
+    return records;
+}
+
+Game* ScenarioCache::restore(const QByteArray &snapshot) {
+    const uchar* cursor = reinterpret_cast<const uchar*>(snapshot.constData());
+    const uchar* end = cursor + snapshot.size();
+    Game* game = readGame(cursor, end);
+    if (game != nullptr && cursor != end) {
+        delete game;
+        return nullptr;
+    }
+    return game;
+}
+
+bool ScenarioCache::readFile(const QString &path, const char *magic, const QByteArray &hash, std::vector<Game *> &games) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = file.size();
+    if (size < (qint64) sizeof(Header)) return false;
+    const uchar* data = file.map(0, size);
+    if (data == nullptr) return false;
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    bool ok = memcmp(header->magic, magic, sizeof(header->magic)) == 0 && header->version == Version
+            && hash.size() == sizeof(header->hash) && memcmp(header->hash, hash.constData(), sizeof(header->hash)) == 0
+            && header->gameCount > 0;
+
+    const uchar* cursor = data + sizeof(Header);
+    const uchar* end = data + size;
+    for (quint32 i = 0; ok && i < header->gameCount; ++i) {
+        Game* game = readGame(cursor, end);
+        if (game == nullptr) ok = false;
+        else games.push_back(game);
+    }
+    // anything left over means we didn't write this
+    ok = ok && cursor == end;
+    file.unmap(const_cast<uchar*>(data));
+
+    if (!ok) {
+        for (Game* g : games) delete g;
+        games.clear();
+    }
+    return ok;
+}
+
+Game* ScenarioCache::readGame(const uchar *&cursor, const uchar *end) {
+    // take the next bytes of the file, or nullptr if they don't fit
+    auto take = [&cursor, end](size_t bytes) -> const uchar* {
+        if ((size_t) (end - cursor) < bytes) return nullptr;
+        const uchar* at = cursor;
+        cursor += bytes;
+        return at;
+    };
+    const GameRecord* header = reinterpret_cast<const GameRecord*>(take(sizeof(GameRecord)));
+    if (header == nullptr) return nullptr;
+    // padded to 8 bytes in 64 bits, so a huge (corrupt) size can't wrap around to nothing
+    const quint64 rngPadded = ((quint64) header->rngSize + 7) & ~(quint64) 7;
+    if (rngPadded > (quint64) (end - cursor)) return nullptr;
+    const char* rngState = reinterpret_cast<const char*>(take(rngPadded));
+    const PocketRecord* pockets = reinterpret_cast<const PocketRecord*>(take(header->pocketCount*sizeof(PocketRecord)));
+    const BallRecord* balls = reinterpret_cast<const BallRecord*>(take(header->ballCount*sizeof(BallRecord)));
+    const NodeRecord* nodes = reinterpret_cast<const NodeRecord*>(take(header->nodeCount*sizeof(NodeRecord)));
+    if (rngState == nullptr || pockets == nullptr || balls == nullptr || nodes == nullptr) return nullptr;
+    const NodeRecord* nodesEnd = nodes + header->nodeCount;
+
+    // the physics divides by radii, and breaking walks a blueprint by its subtree sizes,
+    //  so anything that would hang or throw mid-step later is rejected before building anything
+    const bool stageTwo = header->flags & StageTwo;
+    const NodeRecord* owned = nodes;
+    for (quint32 i = 0; i < header->ballCount; ++i) {
+        const BallRecord& r = balls[i];
+        if (r.radius <= 0) return nullptr;
+        if (!stageTwo || r.childCount == 0 || r.childCount > (quint32) (nodesEnd - owned)) continue;
+        for (quint32 j = 0; j < r.childCount; ++j) {
+            const NodeRecord& n = owned[j];
+            // preorder: parents come first, and every subtree fits in what's left of the blueprint
+            if (n.radius <= 0 || n.parent < -1 || n.parent >= (qint32) j
+                    || n.subtreeSize < 1 || (quint32) n.subtreeSize > r.childCount - j) return nullptr;
+        }
+        owned += r.childCount;
+    }
+
+    Table* table;
+    if (stageTwo) {
+        StageTwoTable* pocketTable = new StageTwoTable(header->tableWidth, header->tableHeight,
+                                                       QColor::fromRgba(header->tableColour), header->friction);
+        for (quint32 i = 0; i < header->pocketCount; ++i) {
+            Pocket* p = new Pocket(pockets[i].radius, QVector2D(pockets[i].x, pockets[i].y));
+            p->setSunk(pockets[i].sunk);
+            pocketTable->addPocket(p);
+        }
+        table = pocketTable;
+    } else {
+        table = new StageOneTable(header->tableWidth, header->tableHeight,
+                                  QColor::fromRgba(header->tableColour), header->friction);
+    }
+
+    std::vector<Ball*>* gameBalls = new std::vector<Ball*>();
+    gameBalls->reserve(header->ballCount);
+    for (quint32 i = 0; i < header->ballCount; ++i) {
+        const BallRecord& r = balls[i];
+        // positions & velocities are set afterwards, so they keep the physics' precision
+        if (!stageTwo) {
+            Ball* ball = new StageOneBall(QColor::fromRgba(r.colour), QVector2D(), QVector2D(), r.mass, r.radius);
+            ball->setPosition(Vector(r.x, r.y));
+            ball->setVelocity(Vector(r.vx, r.vy));
+            ball->addBehaviours(r.behaviours);
+            gameBalls->push_back(ball);
+            continue;
+        }
+        CompositeBall* ball = new CompositeBall(QColor::fromRgba(r.colour), QVector2D(), QVector2D(),
+                                                r.mass, r.radius, r.strength);
+        ball->setPosition(Vector(r.x, r.y));
+        ball->setVelocity(Vector(r.vx, r.vy));
+        ball->addBehaviours(r.behaviours);
+
+        if (r.childCount > 0 && r.childCount <= (quint32) (nodesEnd - nodes)) {
+            std::shared_ptr<BallBlueprint> blueprint = std::make_shared<BallBlueprint>();
+            blueprint->reserve(r.childCount);
+            for (quint32 j = 0; j < r.childCount; ++j) {
+                const NodeRecord& n = nodes[j];
+                blueprint->push_back(BallNode{QColor::fromRgba(n.colour), QVector2D(n.x, n.y), n.mass, n.radius,
+                                              n.strength, n.parent, n.subtreeSize, (int) n.behaviours});
+            }
+            nodes += r.childCount;
+            ball->setChildren(blueprint);
+        }
+        gameBalls->push_back(ball);
+    }
+
+    Game* game = new Game(gameBalls, table);
+    if (header->flags & StageThree) game->setStageThree();
+    if (header->flags & Aiding) game->switchMode();
+    if (header->flags & LocalStepping) game->setLocalStepping(true);
+    if (game->m_cue != nullptr && (header->flags & HasCue)) game->m_cue->setSavedPosition(QVector2D(header->cueX, header->cueY));
+    game->m_breaks = header->breaks;
+    if (header->rngSize > 0) {
+        std::istringstream rng(std::string(rngState, header->rngSize));
+        rng >> game->m_rng;
+    }
+    // the blueprints didn't add up to the number of nodes
+    if (nodes != nodesEnd) {
+        delete game;
+        return nullptr;
+    }
+    return game;
+}
+
+bool ScenarioCache::writeFile(const QString &path, const char *magic, const QByteArray &hash,
+                              const std::vector<Game *> &games, quint32 flags) {
+    if (hash.size() != sizeof(Header::hash)) return false;
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = Version;
+    memcpy(header.hash, hash.constData(), sizeof(header.hash));
+    header.gameCount = games.size();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        std::cerr << "unable to write " << path.toStdString() << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (Game* game : games) {
+        // QSaveFile throws away everything unless we commit
+        if (!writeGame(file, *game, flags)) return false;
+    }
+    return file.commit();
+}
+
+bool ScenarioCache::writeGame(QIODevice &out, Game &game, quint32 flags) {
+    TableVisiter visiter;
+    std::vector<Pocket*>* pockets = visiter.visitTable(game.getTable());
+    const std::vector<Ball*>& balls = game.getBalls();
+    if (pockets != nullptr) flags |= StageTwo;
+    if (game.isStageThree()) flags |= StageThree;
+    if (game.isAiding()) flags |= Aiding;
+    if (game.localStepping()) flags |= LocalStepping;
+
+    // everything in a stage two game is a composite, so gather their blueprints up front
+    std::vector<BallRecord> ballRecords;
+    std::vector<NodeRecord> nodeRecords;
+    for (Ball* b : balls) {
+        const CompositeBall* ball = dynamic_cast<const CompositeBall*>(b);
+        if (ball == nullptr && (flags & StageTwo)) return false;
+
+        const BallBlueprint children = ball ? ball->getChildren() : BallBlueprint();
+        ballRecords.push_back(BallRecord{b->position().x, b->position().y,
+                                         b->velocity().x, b->velocity().y,
+                                         b->getMass(), ball ? ball->getStrength() : DOUBLEINF, b->getRadius(),
+                                         b->getColour().rgba(), (quint32) b->getBehaviours(),
+                                         (quint32) children.size()});
+        for (const BallNode& n : children) {
+            nodeRecords.push_back(NodeRecord{n.offset.x(), n.offset.y(), n.mass, n.strength, n.radius,
+                                             n.colour.rgba(), n.parent, n.subtreeSize, (quint32) n.behaviours, 0});
+        }
+    }
+
+    std::ostringstream rng;
+    rng << game.m_rng;
+    std::string rngState = rng.str();
+    rngState.resize((rngState.size() + 7) & ~size_t(7), ' ');
+
+    GameRecord header;
+    memset(&header, 0, sizeof(header));
+    header.tableWidth = game.getTable()->getWidth();
+    header.tableHeight = game.getTable()->getHeight();
+    header.friction = game.getTable()->getFriction();
+    header.breaks = game.m_breaks;
+    if (game.m_cue != nullptr) {
+        flags |= HasCue;
+        header.cueX = game.m_cue->savedPosition().x();
+        header.cueY = game.m_cue->savedPosition().y();
+    }
+    header.flags = flags;
+    header.tableColour = game.getTable()->getColour().rgba();
+    header.pocketCount = pockets == nullptr ? 0 : pockets->size();
+    header.ballCount = ballRecords.size();
+    header.nodeCount = nodeRecords.size();
+    header.rngSize = rng.str().size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(rngState.data(), rngState.size());
+    for (quint32 i = 0; i < header.pocketCount; ++i) {
+        const Pocket* p = pockets->at(i);
+        PocketRecord r{p->radius(), p->pos().x(), p->pos().y(), p->getSunk()};
+        out.write(reinterpret_cast<const char*>(&r), sizeof(r));
+    }
+    out.write(reinterpret_cast<const char*>(ballRecords.data()), ballRecords.size()*sizeof(BallRecord));
+    out.write(reinterpret_cast<const char*>(nodeRecords.data()), nodeRecords.size()*sizeof(NodeRecord));
+    return true;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QIODevice>
+#include <vector>
+#include "game.h"
+
+/**
+ * @brief The ScenarioCache class
+ * A compiled, binary copy of a (stage two) config. Building a game from json validates every ball,
+ *  so we only do that once, and store the result keyed by a hash of the json.
+ *  Loading maps the file, and creates the game directly from its records.
+ *
+ * The same records make up checkpoints: the full state of a running game (sunk counts, strategy,
+ *  random source, ...) along with its undo history, so a session can be resumed somewhere else.
+ *
+ * Layout: Header, then Header::gameCount games. Each game is a GameRecord, GameRecord::rngSize bytes of
+ *  random source state (padded to 8 bytes), GameRecord::pocketCount PocketRecords, GameRecord::ballCount
+ *  BallRecords, then GameRecord::nodeCount NodeRecords (each ball's BallRecord::childCount nodes, in ball order)
+ */
+class ScenarioCache {
+public:
+    // bump whenever any of the records change
+    static constexpr quint32 Version = 3;
+    // game flags, i.e. which stages the config enabled
+    enum Flags { StageTwo = 1 << 0, StageThree = 1 << 1, Aiding = 1 << 2, HasCue = 1 << 3, LocalStepping = 1 << 4 };
+
+    /**
+     * @brief hash - the key of the config
+     * @param json - the raw contents of the config file
+     * @return the hash of the config
+     */
+    static QByteArray hash(const QByteArray& json);
+    /**
+     * @brief hash - the key of the config, without reading it all into memory
+     * @param device - the config file, read until its end
+     * @return the hash of the config
+     */
+    static QByteArray hash(QIODevice* device);
+
+    /**
+     * @brief load - create a game from the cache file, if the cache matches the config
+     * @param path - the cache file
+     * @param hash - the hash of the current config
+     * @return the game, or nullptr if the cache is missing, stale or corrupt
+     */
+    static Game* load(const QString& path, const QByteArray& hash);
+
+    /**
+     * @brief save - compile a freshly built game into the cache file
+     * @param path - the cache file (replaced atomically)
+     * @param hash - the hash of the config that built the game
+     * @param game - the game to store, it must be a stage two game
+     * @param flags - Flags of the config
+     * @return whether the cache was written
+     */
+    static bool save(const QString& path, const QByteArray& hash, Game& game, quint32 flags);
+
+    /**
+     * @brief saveCheckpoint - store a running game, and its undo history
+     * @param path - the checkpoint file (replaced atomically)
+     * @param game - the game being played
+     * @param history - the saved games that undo goes back to, oldest first
+     * @return whether the checkpoint was written
+     */
+    static bool saveCheckpoint(const QString& path, Game& game, const std::vector<Game*>& history);
+
+    /**
+     * @brief loadCheckpoint - resume a game exactly where it was saved
+     * @param path - the checkpoint file
+     * @param history - filled with the saved games that undo goes back to, oldest first (owned by the caller)
+     * @return the game, or nullptr if the checkpoint is missing or corrupt
+     */
+    static Game* loadCheckpoint(const QString& path, std::vector<Game*>& history);
+
+    /**
+     * @brief snapshot - the full state of a game in memory, the same as it would be in a checkpoint
+     * @param game - the game to store
+     * @return the game's records
+     */
+    static QByteArray snapshot(Game& game);
+
+    /**
+     * @brief restore - recreate a game from a snapshot
+     * @param snapshot - the records from snapshot
+     * @return the game, exactly as it was, or nullptr if the snapshot is corrupt
+     */
+    static Game* restore(const QByteArray& snapshot);
+
+private:
+    // all records are plain data with natural alignment, so they can be read in place
+    struct Header {
+        char magic[4];
+        quint32 version;
+        char hash[20];
+        quint32 gameCount;
+    };
+    struct GameRecord {
+        double tableWidth;
+        double tableHeight;
+        double friction;
+        quint64 breaks;
+        // the cue's position before the last shot
+        float cueX, cueY;
+        quint32 flags;
+        quint32 tableColour;
+        quint32 pocketCount;
+        quint32 ballCount;
+        quint32 nodeCount;
+        quint32 rngSize;
+    };
+    struct PocketRecord {
+        double radius;
+        float x, y;
+        quint64 sunk;
+    };
+    struct BallRecord {
+        // double, so that neither precision of the physics loses anything
+        double x, y;
+        double vx, vy;
+        double mass;
+        double strength;
+        qint32 radius;
+        quint32 colour;
+        quint32 behaviours;
+        quint32 childCount;
+    };
+    struct NodeRecord {
+        float x, y;
+        double mass;
+        double strength;
+        qint32 radius;
+        quint32 colour;
+        qint32 parent;
+        qint32 subtreeSize;
+        quint32 behaviours;
+        quint32 padding;
+    };
+    static constexpr char Magic[4] = {'P', 'G', 'S', 'C'};
+    static constexpr char CheckpointMagic[4] = {'P', 'G', 'C', 'K'};
+
+    /**
+     * @brief writeFile - write the header & games, atomically
+     * @return whether everything was written
+     */
+    static bool writeFile(const QString& path, const char* magic, const QByteArray& hash,
+                          const std::vector<Game*>& games, quint32 flags);
+    /**
+     * @brief writeGame - append one game's records
+     * @param out - where to write to
+     * @param game - the game to write
+     * @param flags - Flags to add to the game's own
+     * @return whether the game could be stored
+     */
+    static bool writeGame(QIODevice& out, Game& game, quint32 flags);
+    /**
+     * @brief readGame - create a game from its records
+     * @param cursor - the start of the game's GameRecord, moved past the game
+     * @param end - the end of the file
+     * @return the game, or nullptr if the records run past the end of the file
+     */
+    static Game* readGame(const uchar*& cursor, const uchar* end);
+    /**
+     * @brief readFile - map the file, check its header, and read all of its games
+     * @param games - filled with the games, owned by the caller
+     * @return whether the whole file was read
+     */
+    static bool readFile(const QString& path, const char* magic, const QByteArray& hash, std::vector<Game*>& games);
+};
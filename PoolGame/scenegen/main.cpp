@@ -0,0 +1,135 @@
+/**
+ * scenegen - write reproducible stage two scenes, for profiling with large inputs
+ *  e.g. scenegen --balls 10000 --depth 3 --table 8000x4000 --seed 7 --scenario config.scenario config.json
+ */
+
+#include "scenegenerator.h"
+#include "scenariocache.h"
+#include "gamebuilder.h"
+#include "stagetwobuilder.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QFile>
+#include <iostream>
+
+/**
+ * @brief parseRange - read "min:max" (or a single value for both)
+ * @return whether the text was valid
+ */
+static bool parseRange(const QString& text, double& min, double& max) {
+    QStringList parts = text.split(":");
+    bool okMin = false, okMax = false;
+    min = parts.at(0).toDouble(&okMin);
+    max = parts.size() > 1 ? parts.at(1).toDouble(&okMax) : min;
+    if (parts.size() == 1) okMax = okMin;
+    return parts.size() <= 2 && okMin && okMax && min <= max;
+}
+
+/* read a number, clearing ok if the text isn't one (rather than quietly reading it as 0) */
+static int parseInt(const QString& text, bool& ok) {
+    bool valid = false;
+    const int v = text.toInt(&valid);
+    ok = ok && valid;
+    return v;
+}
+
+static double parseDouble(const QString& text, bool& ok) {
+    bool valid = false;
+    const double v = text.toDouble(&valid);
+    ok = ok && valid;
+    return v;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("scenegen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate config.json compatible pool scenes");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Where to write the json scene (stdout if omitted)");
+    QCommandLineOption ballsOpt("balls", "Number of top level balls", "count", "100");
+    QCommandLineOption radiusOpt("radius", "Top level radius range", "min:max", "8:20");
+    QCommandLineOption depthOpt("depth", "Levels of nested balls", "levels", "1");
+    QCommandLineOption childrenOpt("children", "Most nested balls per level", "count", "3");
+    QCommandLineOption strengthOpt("strength", "Strength range (log-uniform)", "min:max", "100:50000");
+    QCommandLineOption unbreakableOpt("unbreakable", "Chance of a ball being unbreakable", "chance", "0.5");
+    QCommandLineOption speedOpt("speed", "Most initial speed of non-cue balls", "speed", "0");
+    QCommandLineOption pocketsOpt("pockets", "Pocket layout: none, corners, standard or random[:count]", "layout", "standard");
+    QCommandLineOption pocketRadiusOpt("pocket-radius", "Pocket radius", "radius", "30");
+    QCommandLineOption tableOpt("table", "Table size", "WxH", "1000x500");
+    QCommandLineOption frictionOpt("friction", "Table friction", "friction", "0.1");
+    QCommandLineOption seedOpt("seed", "Random seed", "seed", "1");
+    QCommandLineOption scenarioOpt("scenario", "Also compile the scene into a binary scenario file", "file");
+    parser.addOptions({ballsOpt, radiusOpt, depthOpt, childrenOpt, strengthOpt, unbreakableOpt, speedOpt,
+                       pocketsOpt, pocketRadiusOpt, tableOpt, frictionOpt, seedOpt, scenarioOpt});
+    parser.process(app);
+
+    SceneParameters params;
+    double minRadius, maxRadius;
+    QStringList pockets = parser.value(pocketsOpt).split(":");
+    QStringList table = parser.value(tableOpt).split("x");
+    bool ok = parseRange(parser.value(radiusOpt), minRadius, maxRadius)
+            && parseRange(parser.value(strengthOpt), params.minStrength, params.maxStrength)
+            && params.parsePocketLayout(pockets.at(0)) && pockets.size() <= 2 && table.size() == 2;
+    params.minRadius = minRadius;
+    params.maxRadius = maxRadius;
+    params.ballCount = parseInt(parser.value(ballsOpt), ok);
+    params.depth = parseInt(parser.value(depthOpt), ok);
+    params.maxChildren = parseInt(parser.value(childrenOpt), ok);
+    params.unbreakableChance = parseDouble(parser.value(unbreakableOpt), ok);
+    params.maxSpeed = parseDouble(parser.value(speedOpt), ok);
+    if (pockets.size() > 1) params.randomPocketCount = parseInt(pockets.at(1), ok);
+    params.pocketRadius = parseDouble(parser.value(pocketRadiusOpt), ok);
+    if (table.size() == 2) {
+        params.tableWidth = parseInt(table.at(0), ok);
+        params.tableHeight = parseInt(table.at(1), ok);
+    }
+    params.friction = parseDouble(parser.value(frictionOpt), ok);
+    bool validSeed = false;
+    params.seed = parser.value(seedOpt).toUInt(&validSeed);
+    // negative counts (or speeds, or strengths) would make empty ranges for the generator to draw from,
+    //  and the rest would make a table the game can't play (or a chance that isn't one)
+    ok = ok && validSeed && params.ballCount >= 0 && params.depth >= 0 && params.maxChildren >= 0 && params.randomPocketCount >= 0
+            && params.maxSpeed >= 0 && params.minStrength > 0 && params.pocketRadius > 0 && params.friction >= 0
+            && params.unbreakableChance >= 0 && params.unbreakableChance <= 1;
+    if (!ok || params.minRadius < 2 || params.tableWidth <= 0 || params.tableHeight <= 0) {
+        std::cerr << "invalid arguments\n";
+        parser.showHelp(1);
+    }
+
+    SceneGenerator generator(params);
+    QJsonObject conf = generator.generate();
+    if (generator.placed() < params.ballCount) {
+        std::cerr << "table only fits " << generator.placed() << " balls\n";
+    }
+    // large scenes are written compactly
+    QByteArray json = QJsonDocument(conf).toJson(params.ballCount > 1000 ? QJsonDocument::Compact : QJsonDocument::Indented);
+
+    const QStringList outputs = parser.positionalArguments();
+    QFile out;
+    bool opened = outputs.isEmpty() ? out.open(stdout, QIODevice::WriteOnly)
+                                    : (out.setFileName(outputs.at(0)), out.open(QIODevice::WriteOnly));
+    if (!opened || out.write(json) != json.size()) {
+        std::cerr << "unable to write the scene\n";
+        return 1;
+    }
+    out.close();
+
+    // build it exactly like the game would, keyed by the json we just wrote
+    if (parser.isSet(scenarioOpt)) {
+        GameDirector director(&conf);
+        director.setBuilder(new StageTwoBuilder());
+        Game* game = director.createGame();
+        const quint32 flags = params.stageThree ? ScenarioCache::StageThree : 0;
+        bool saved = ScenarioCache::save(parser.value(scenarioOpt), ScenarioCache::hash(json), *game, flags);
+        delete game;
+        if (!saved) {
+            std::cerr << "unable to write the scenario\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "scenegenerator.h"
+#include <QColor>
+#include <QVector2D>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+bool SceneParameters::parsePocketLayout(const QString &name) {
+    if (name == "none") pockets = NoPockets;
+    else if (name == "corners") pockets = CornerPockets;
+    else if (name == "standard") pockets = StandardPockets;
+    else if (name == "random") pockets = RandomPockets;
+    else return false;
+    return true;
+}
+
+QJsonObject SceneGenerator::generate() {
+    m_rng.seed(m_params.seed);
+
+    QJsonObject table = generateTable();
+    const QJsonArray pockets = table.value("pockets").toArray();
+
+    // place balls in the cells of a grid (in a random order), so that no two balls can overlap
+    const int cellSize = 2*m_params.maxRadius + 2;
+    const int columns = std::max(0, (m_params.tableWidth - 2) / cellSize);
+    const int rows = std::max(0, (m_params.tableHeight - 2) / cellSize);
+    std::vector<int> cells;
+    cells.reserve(columns*rows);
+    for (int i = 0; i < columns*rows; ++i) {
+        // keep the cells clear of the pockets
+        QVector2D centre(1 + (i % columns + 0.5)*cellSize, 1 + (i / columns + 0.5)*cellSize);
+        bool clear = true;
+        for (const QJsonValueRef p : pockets) {
+            QJsonObject pos = p.toObject().value("position").toObject();
+            QVector2D pocket(pos.value("x").toDouble(), pos.value("y").toDouble());
+            if (pocket.distanceToPoint(centre) < p.toObject().value("radius").toDouble() + cellSize) {
+                clear = false;
+                break;
+            }
+        }
+        if (clear) cells.push_back(i);
+    }
+    std::shuffle(cells.begin(), cells.end(), m_rng);
+
+    QJsonArray balls;
+    m_placed = std::min<int>(m_params.ballCount, cells.size());
+    for (int i = 0; i < m_placed; ++i) {
+        const int radius = uniformInt(m_params.minRadius, m_params.maxRadius);
+        // jitter within whatever room the cell has left
+        const double slack = cellSize/2.0 - radius - 1;
+        const double x = 1 + (cells[i] % columns + 0.5)*cellSize + uniform(-slack, slack);
+        const double y = 1 + (cells[i] / columns + 0.5)*cellSize + uniform(-slack, slack);
+
+        QJsonObject ball;
+        ball["position"] = QJsonObject({{"x", x}, {"y", y}});
+        ball["radius"] = radius;
+        ball["mass"] = uniform(1, 4);
+        // the first ball is the cue ball, so keep it plain and still
+        if (i == 0) {
+            ball["colour"] = "white";
+        } else {
+            ball["colour"] = generateColour();
+            addStrength(ball);
+            if (m_params.maxSpeed > 0) {
+                const double angle = uniform(0, 2*M_PI);
+                const double speed = uniform(0, m_params.maxSpeed);
+                ball["velocity"] = QJsonObject({{"x", speed*cos(angle)}, {"y", speed*sin(angle)}});
+            }
+            if (m_params.depth > 0) {
+                QJsonArray children = generateChildren(radius, m_params.depth);
+                if (children.size() > 0) ball["balls"] = children;
+            }
+        }
+        balls.append(ball);
+    }
+
+    QJsonObject conf;
+    conf["stage2"] = true;
+    conf["stage3"] = m_params.stageThree;
+    conf["table"] = table;
+    conf["balls"] = balls;
+    return conf;
+}
+
+QJsonObject SceneGenerator::generateTable() {
+    QJsonObject table;
+    table["colour"] = "green";
+    table["size"] = QJsonObject({{"x", m_params.tableWidth}, {"y", m_params.tableHeight}});
+    table["friction"] = m_params.friction;
+    table["pockets"] = generatePockets();
+    return table;
+}
+
+QJsonArray SceneGenerator::generatePockets() {
+    const double w = m_params.tableWidth;
+    const double h = m_params.tableHeight;
+    // just inside the corners, like the default config
+    const double inset = 5;
+    std::vector<QVector2D> positions;
+
+    switch (m_params.pockets) {
+    case SceneParameters::StandardPockets:
+        positions.push_back(QVector2D(w/2, inset));
+        positions.push_back(QVector2D(w/2, h - inset));
+        // fall through, standard tables also have the corners
+    case SceneParameters::CornerPockets:
+        positions.push_back(QVector2D(inset, inset));
+        positions.push_back(QVector2D(w - inset, inset));
+        positions.push_back(QVector2D(w - inset, h - inset));
+        positions.push_back(QVector2D(inset, h - inset));
+        break;
+    case SceneParameters::RandomPockets:
+        for (int i = 0; i < m_params.randomPocketCount; ++i) {
+            positions.push_back(QVector2D(uniform(inset, w - inset), uniform(inset, h - inset)));
+        }
+        break;
+    case SceneParameters::NoPockets:
+        break;
+    }
+
+    QJsonArray pockets;
+    for (const QVector2D& p : positions) {
+        pockets.append(QJsonObject({{"position", QJsonObject({{"x", p.x()}, {"y", p.y()}})},
+                                    {"radius", m_params.pocketRadius}}));
+    }
+    return pockets;
+}
+
+QString SceneGenerator::generateColour() {
+    QColor colour(uniformInt(0, 255), uniformInt(0, 255), uniformInt(0, 255));
+    return colour.name();
+}
+
+void SceneGenerator::addStrength(QJsonObject &ball) {
+    // no strength means unbreakable
+    if (uniform(0, 1) < m_params.unbreakableChance) return;
+    ball["strength"] = exp(uniform(log(m_params.minStrength), log(m_params.maxStrength)));
+}
+
+QJsonArray SceneGenerator::generateChildren(int radius, int depth) {
+    QJsonArray children;
+    const int count = uniformInt(0, m_params.maxChildren);
+    for (int i = 0; i < count; ++i) {
+        const int childRadius = uniformInt(std::max(2, radius/4), std::max(2, radius/2));
+        // keep well within the parent, so that the builder never rejects it
+        const double limit = std::max(0.0, (radius - childRadius)/M_SQRT2);
+
+        QJsonObject child;
+        child["position"] = QJsonObject({{"x", uniform(-limit, limit)}, {"y", uniform(-limit, limit)}});
+        child["radius"] = childRadius;
+        child["mass"] = uniform(1, 4);
+        child["colour"] = generateColour();
+        addStrength(child);
+        if (depth > 1 && childRadius >= 4) {
+            QJsonArray grandChildren = generateChildren(childRadius, depth - 1);
+            if (grandChildren.size() > 0) child["balls"] = grandChildren;
+        }
+        children.append(child);
+    }
+    return children;
+}
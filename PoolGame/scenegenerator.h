@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QString>
+#include <random>
+
+/**
+ * @brief The SceneParameters struct - everything that shapes a generated scene
+ */
+struct SceneParameters {
+    // how many top level balls (the first is the cue ball)
+    int ballCount = 100;
+    // top level radii are uniform in [minRadius, maxRadius]
+    int minRadius = 8;
+    int maxRadius = 20;
+    // how many levels of nested balls, and how many children (at most) each level has
+    int depth = 1;
+    int maxChildren = 3;
+    // breakable strengths are log-uniform in [minStrength, maxStrength]
+    double minStrength = 100;
+    double maxStrength = 50000;
+    // the chance of a ball being unbreakable
+    double unbreakableChance = 0.5;
+    // top level balls (other than the cue) start with a speed uniform in [0, maxSpeed]
+    double maxSpeed = 0;
+
+    enum PocketLayout { NoPockets, CornerPockets, StandardPockets, RandomPockets };
+    PocketLayout pockets = StandardPockets;
+    // how many pockets the random layout has
+    int randomPocketCount = 6;
+    double pocketRadius = 30;
+
+    int tableWidth = 1000;
+    int tableHeight = 500;
+    double friction = 0.1;
+
+    bool stageThree = true;
+    unsigned int seed = 1;
+
+    /**
+     * @brief parsePocketLayout - read a layout from its name (none, corners, standard or random)
+     * @return whether the name was valid
+     */
+    bool parsePocketLayout(const QString& name);
+};
+
+/**
+ * @brief The SceneGenerator class
+ * Creates reproducible, config.json compatible stage two scenes. The same parameters (and seed)
+ *  always give the same scene.
+ */
+class SceneGenerator {
+public:
+    SceneGenerator(const SceneParameters& params) : m_params(params), m_rng(params.seed) {}
+
+    /**
+     * @brief generate - create a scene
+     * @return the whole config, ready to be given to the GameDirector or written out
+     */
+    QJsonObject generate();
+
+    /**
+     * @brief placed - how many top level balls the last scene actually has.
+     *  this is less than ballCount if the table is too small to fit them all
+     */
+    int placed() const { return m_placed; }
+
+private:
+    SceneParameters m_params;
+    std::mt19937 m_rng;
+    int m_placed = 0;
+
+    double uniform(double min, double max) { return std::uniform_real_distribution<double>(min, max)(m_rng); }
+    int uniformInt(int min, int max) { return std::uniform_int_distribution<int>(min, max)(m_rng); }
+
+    QJsonObject generateTable();
+    QJsonArray generatePockets();
+    /* a random colour, as a hex string */
+    QString generateColour();
+    /* a random strength (which may be none, i.e. unbreakable) added to the ball */
+    void addStrength(QJsonObject& ball);
+    /**
+     * @brief generateChildren - create the nested balls of a ball
+     * @param radius - the radius of the containing ball
+     * @param depth - how many more levels of nesting there may be
+     */
+    QJsonArray generateChildren(int radius, int depth);
+};
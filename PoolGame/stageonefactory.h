@@ -17,6 +17,7 @@ public:
      */
     virtual Table* makeTable(const QJsonObject& tableData) override;
 
-    // invalid state if this is called!
+    // invalid state if these are called!
+    virtual BallNode makeBallNode(const QJsonObject&) override { throw std::logic_error("unimplemented"); }
     virtual Pocket* makePocket(const QJsonObject&) override { throw std::logic_error("unimplemented"); return nullptr; }
 };
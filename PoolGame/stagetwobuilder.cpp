@@ -4,9 +4,11 @@
 #include <QJsonArray>
 #include <cassert>
 #include <functional>
+#include <sstream>
+#include <QtConcurrent>
 #include "ball.h"
 
-QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* defaultColour) {
+QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* defaultColour, std::ostream& log) {
 
     // default colour is white
     if (!bData.contains("colour")) {
@@ -15,7 +17,7 @@ QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* de
 
     QString col = bData["colour"].toString(QString("Xx_420_noscope_invalidcolour_xX"));
     if (!isValidColour(col)) {
-        std::cerr << "invalid ball colour supplied\n";
+        log << "invalid ball colour supplied\n";
         bData["colour"] = "white";
     }
 
@@ -23,7 +25,7 @@ QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* de
     constexpr double defaultMass = 1.0;
     if (!bData.contains("mass")) bData["mass"] = defaultMass;
     if (bData["mass"].toDouble() == DOUBLEINF || bData["mass"].toDouble() <= 0) {
-        std::cerr << "invalid ball mass\n";
+        log << "invalid ball mass\n";
         bData["mass"] = defaultMass;
     }
 
@@ -31,7 +33,7 @@ QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* de
     if (!bData.contains("strength")) bData["strength"] = DOUBLEINF;
     if (bData["strength"].toDouble(std::numeric_limits<double>::min()) == std::numeric_limits<double>::min()
                       || bData["strength"].toDouble() <= 0) {
-        std::cerr << "invalid strength\n";
+        log << "invalid strength\n";
         bData["strength"] = DOUBLEINF;
     }
 
@@ -40,7 +42,7 @@ QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* de
     if (!bData.contains("radius")) bData["radius"] = defaultRadius;
     double radius = bData["radius"].toDouble(DOUBLEINF);
     if (radius == DOUBLEINF || radius <= 0) {
-        std::cerr << "invalid radius";
+        log << "invalid radius";
         bData["radius"] = defaultRadius;
     }
 
@@ -54,12 +56,12 @@ QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* de
             double velx = qjVel.value("x").toDouble(DOUBLEINF);
             double vely = qjVel.value("y").toDouble(DOUBLEINF);
             if (velx == DOUBLEINF) {
-                std::cerr << "invalid xvelocity\n";
+                log << "invalid xvelocity\n";
                 velx = defaultVelocity;
             }
             if (vely == DOUBLEINF) {
                 vely = defaultVelocity;
-                std::cerr << "invalid yvelocity\n";
+                log << "invalid yvelocity\n";
             }
             bData["velocity"] = QJsonObject({{"x",velx}, {"y",vely}});
         }
@@ -73,11 +75,11 @@ QJsonObject StageTwoBuilder::addDefaultsToBall(QJsonObject bData, const char* de
         double posx = qjPos.value("x").toDouble(DOUBLEINF);
         double posy = qjPos.value("y").toDouble(DOUBLEINF);
         if (posx == DOUBLEINF) {
-            std::cerr << "invalid xvelocity\n";
+            log << "invalid xvelocity\n";
             posx = defaultPos;
         }
         if (posy == DOUBLEINF) {
-            std::cerr << "invalid yvelocity\n";
+            log << "invalid yvelocity\n";
             posy = defaultPos;
         }
         bData["position"] = QJsonObject({{"x",posx}, {"y",posy}});
@@ -143,64 +145,120 @@ void StageTwoBuilder::addBall(QJsonObject &ballData) {
         m_buildingBalls = new std::vector<Ball*>();
     }
 
+    Ball* b = buildBall(ballData, std::cerr);
+    if (b != nullptr) m_buildingBalls->push_back(b);
+}
+
+void StageTwoBuilder::addBalls(const QJsonArray &ballData) {
+    if (!m_parallel || ballData.size() < ParallelThreshold) {
+        GameBuilder::addBalls(ballData);
+        return;
+    }
+
+    // if we haven't already started building
+    if (m_buildingBalls == nullptr) {
+        m_buildingBalls = new std::vector<Ball*>();
+    }
+
+    // build every ball on the pool, then merge the results (and what was wrong with them) in the original order
+    QList<QJsonObject> objects;
+    for (const auto& item : ballData) objects.append(item.toObject());
+    std::function<BuiltBall(const QJsonObject&)> build = [this](const QJsonObject& b) {
+        std::ostringstream log;
+        Ball* ball = buildBall(b, log);
+        return BuiltBall{ball, log.str()};
+    };
+    QVector<BuiltBall> built = QtConcurrent::blockingMapped<QVector<BuiltBall>>(objects, build);
+
+    m_buildingBalls->reserve(m_buildingBalls->size() + built.size());
+    for (const BuiltBall& b : built) {
+        std::cerr << b.messages;
+        if (b.ball != nullptr) m_buildingBalls->push_back(b.ball);
+    }
+}
+
+Ball* StageTwoBuilder::buildBall(const QJsonObject &ballData, std::ostream &log) const {
     // clean & set the defaults for the top level ball
-    QJsonObject cleanerBall = addDefaultsToBall(ballData);
+    QJsonObject cleanerBall = addDefaultsToBall(ballData, "white", log);
     assert(!cleanerBall.isEmpty() && "somehow the balls hasn't been created properly?");
 
     Ball* b = m_factory->makeBall(cleanerBall);
     // ensure that the ball is within the table bounds
     if (!ballWithinTable(b, m_buildingTable)) {
-        std::cerr << "ball placed off table, ignoring\n";
+        log << "ball placed off table, ignoring\n";
         delete b;
-        return;
+        return nullptr;
     }
 
-    // generate the balls & add as children the nested balls, returning the generated ball, C++11 style
-    std::function<Ball*(const QJsonObject&, const double&, const std::string&)> genBalls = [&](const QJsonObject& inV, const double& parentRadius, const std::string& parentColour) -> Ball* {
-        // update defaults, but ignore ball if invalid
-        QJsonObject cleanIn = convertAndCheckBall(inV, parentRadius, parentColour);
-        if (cleanIn.isEmpty()) return nullptr;
+    // children are only kept as a blueprint, they become real balls if their parent ever breaks
+    std::shared_ptr<BallBlueprint> blueprint = std::make_shared<BallBlueprint>();
 
-        Ball* innerB = m_factory->makeBall(cleanIn);
+    // append the node & its nested balls to the blueprint, returning whether the ball was valid, C++11 style
+    std::function<bool(const QJsonObject&, const double&, const std::string&, int, const QVector2D&)> genNodes =
+            [&](const QJsonObject& inV, const double& parentRadius, const std::string& parentColour,
+                int parent, const QVector2D& origin) -> bool {
+        // update defaults, but ignore ball if invalid
+        QJsonObject cleanIn = convertAndCheckBall(inV, parentRadius, parentColour, log);
+        if (cleanIn.isEmpty()) return false;
+
+        const int self = blueprint->size();
+        BallNode node = m_factory->makeBallNode(cleanIn);
+        node.parent = parent;
+        node.offset += origin;
+        blueprint->push_back(node);
         // leaf ball doesn't have children, i.e. non-composite
-        if (!cleanIn.contains("balls")) return innerB;
+        if (!cleanIn.contains("balls")) return true;
 
-        // generate and add children for each of the balls
-        CompositeBall* compB = static_cast<CompositeBall*>(innerB);
         const double radius = cleanIn["radius"].toDouble();
         const std::string colour = cleanIn["colour"].toString().toStdString();
-
         for (const QJsonValueRef ov : cleanIn.value("balls").toArray()) {
             QJsonObject tmp = ov.toObject();
-            // add as a child if the ball is   valid
-            Ball* c = genBalls(tmp, radius, colour);
-            if (c != nullptr) compB->addChild(c);
+            // invalid children are silently dropped
+            genNodes(tmp, radius, colour, self, node.offset);
         }
-        return innerB;
+        blueprint->at(self).subtreeSize = blueprint->size() - self;
+        return true;
     };
 
     // add all of our children if they exist
     {
         const double radius = cleanerBall["radius"].toDouble();
         const std::string colour = cleanerBall["colour"].toString().toStdString();
-        // recursively add composite balls
         CompositeBall* b2 = dynamic_cast<CompositeBall*>(b);
-        if (b2 != nullptr) {
+        if (b2 != nullptr && cleanerBall.contains("balls")) {
             for (const QJsonValueRef v : cleanerBall.value("balls").toArray()) {
                 QJsonObject tmp = v.toObject();
 
                 // generate and ensure child ball is valid
-                Ball* c = genBalls(tmp, radius, colour);
-                if (c != nullptr) {
-                    b2->addChild(c);
-                } else {
-                    std::cerr << "invalid child ball, ignoring\n";
+                if (!genNodes(tmp, radius, colour, -1, QVector2D())) {
+                    log << "invalid child ball, ignoring\n";
                 }
             }
+            b2->setChildren(blueprint);
         }
     }
 
-    m_buildingBalls->push_back(b);
+    return b;
+}
+
+void StageTwoBuilder::addBuiltBall(Ball *ball) {
+    // if we haven't already started building
+    if (m_buildingBalls == nullptr) {
+        m_buildingBalls = new std::vector<Ball*>();
+    }
+    // ensure that the ball is within the table bounds
+    if (!ballWithinTable(ball, m_buildingTable)) {
+        std::cerr << "ball placed off table, ignoring\n";
+        delete ball;
+        return;
+    }
+    m_buildingBalls->push_back(ball);
+}
+
+void StageTwoBuilder::addBuiltTable(Table *table) {
+    // ensure that we haven't already created another table
+    if (m_buildingTable != nullptr) throw std::invalid_argument("table created twice");
+    m_buildingTable = table;
 }
 
 void StageTwoBuilder::addTable(QJsonObject &tableDatax) {
@@ -244,25 +302,11 @@ Game* StageTwoBuilder::getResult() {
         addBall(defaultBall);
     }
 
-    // set the first ball to be cue ball
+    // set the first ball to be cue ball (the game gives it the cue behaviour)
     // XXX: Patrick didn't follow the rules (first WHITE)
-    Ball* c = m_buildingBalls->front();
-    CueBall* cb = new CueBall(c);
-    m_buildingBalls->front() = static_cast<Ball*>(cb);
-
-    // just for fun, lets make a random ball have a trail
-    size_t ind = rand()%m_buildingBalls->size();
-    Ball* sparkleBall = m_buildingBalls->at(ind);
-    m_buildingBalls->at(ind) =  new BallSparkleDecorator(sparkleBall);
-
-    // and a random ball have bump effects
-    ind = rand()%m_buildingBalls->size();
-    Ball* bumpBall = m_buildingBalls->at(ind);
-    m_buildingBalls->at(ind) = new BallSmashDecorator(bumpBall);
+    m_buildingBalls->front()->setCue();
 
     Game* retGame = new Game(m_buildingBalls, m_buildingTable);
-    // register all the mouse functions for the cueball
-    retGame->addMouseFunctions(cb->getEvents());
 
     // need to reset for when we build next
     m_buildingBalls = nullptr;
@@ -271,6 +315,19 @@ Game* StageTwoBuilder::getResult() {
     return retGame;
 }
 
+void StageTwoBuilder::decorate(Game &game) {
+    const std::vector<Ball*>& balls = game.getBalls();
+    if (balls.empty()) return;
+
+    // just for fun, lets make a random ball have a trail
+    size_t ind = rand()%balls.size();
+    balls.at(ind)->addBehaviours(SparkleBehaviour);
+
+    // and a random ball have bump effects
+    ind = rand()%balls.size();
+    balls.at(ind)->addBehaviours(SmashBehaviour);
+}
+
 bool StageTwoBuilder::ballWithinTable(const Ball *ball, const Table *table) {
     QVector2D bPos = ball->getPosition();
     // ball is beyond left side of table's bounds
@@ -292,9 +349,10 @@ bool StageTwoBuilder::ballWithinTable(const Ball *ball, const Table *table) {
     return true;
 }
 
-QJsonObject StageTwoBuilder::convertAndCheckBall(QJsonObject bData, const double parentRadius, const std::string &parentColour) {
+QJsonObject StageTwoBuilder::convertAndCheckBall(QJsonObject bData, const double parentRadius, const std::string &parentColour,
+                                                 std::ostream &log) {
     // update defaults (necessary to do first so that we can set default radii, and pos)
-    bData = addDefaultsToBall(bData, parentColour.c_str());
+    bData = addDefaultsToBall(bData, parentColour.c_str(), log);
 
     const double radius = bData["radius"].toDouble();
     QJsonObject pos = bData["position"].toObject();
@@ -7,14 +7,65 @@
 class StageTwoBuilder : public GameBuilder {
 public:
     ~StageTwoBuilder() {}
-    StageTwoBuilder(): GameBuilder(new StageTwoFactory()) {}
+    /**
+     * @param parallel - whether large arrays of balls are built across all cores
+     */
+    StageTwoBuilder(bool parallel = true): GameBuilder(new StageTwoFactory()), m_parallel(parallel) {}
 
     void addBall(QJsonObject &ballData) override;
+
+    /**
+     * @brief addBalls creates every ball in the array. Balls are independent of each other, so large
+     *  arrays are built on a thread pool (in parallel mode), keeping the order of the config
+     * @param ballData - the array of balls provided in the config
+     */
+    void addBalls(const QJsonArray& ballData) override;
     void addTable(QJsonObject &tableData) override;
 
+    /**
+     * @brief addBuiltBall - add a ball that has already been created (and had its defaults set)
+     *  it is deleted if it's not within the table, so the table must be added first
+     * @param ball - the ball, ownership is taken
+     */
+    void addBuiltBall(Ball* ball);
+
+    /**
+     * @brief addBuiltTable - use a table that has already been created (along with its pockets)
+     * @param table - the table, ownership is taken
+     */
+    void addBuiltTable(Table* table);
+
     virtual Game* getResult() override;
 
+    /**
+     * @brief decorate - give a random ball a trail, and another bump effects. Left out of getResult so
+     *  the scenario cache only holds what the config says, and every launch rolls them again
+     * @param game - a freshly built (or loaded) stage two game
+     */
+    static void decorate(Game& game);
+
 private:
+    // the streaming director applies the same rules as we do
+    friend class StreamingGameDirector;
+
+    // fewer balls than this aren't worth the threads
+    static constexpr int ParallelThreshold = 64;
+    bool m_parallel;
+
+    // a ball built on the pool, along with what was wrong with it (printed once they're back in order)
+    struct BuiltBall {
+        Ball* ball;
+        std::string messages;
+    };
+
+    /**
+     * @brief buildBall - create a top level ball and its children. safe to call from many threads at once
+     * @param ballData - json object that is an element of the array of balls provided in the config
+     * @param log - where to say what was wrong with the ball
+     * @return the ball, or nullptr if it should be ignored
+     */
+    Ball* buildBall(const QJsonObject& ballData, std::ostream& log) const;
+
     // helper functions to ensure json is valid & well constructed
 
     /* return whether the pocket is valid */
@@ -27,18 +78,21 @@ private:
      * @param bData - the json to check and read data from
      * @param parentRadius - the parent's radius for this ball (check whether within the ball radii)
      * @param parentColour - the parent's colour, we set the ball's colour to this if not specified in bData
+     * @param log - where to say what was wrong with the ball
      * @return the resulting valid (or empty if invalid) bal data
      */
-    static QJsonObject convertAndCheckBall(QJsonObject bData, const double parentRadius, const std::string& parentColour);
+    static QJsonObject convertAndCheckBall(QJsonObject bData, const double parentRadius, const std::string& parentColour,
+                                           std::ostream& log = std::cerr);
 
     // just update to defaults if missing values (non-recursive)
     /**
      * @brief addDefaultsToBall - just set the defaults for the ball (non-recursive) if they are not valid, or don't exist
      * @param bData - the starting ball data
      * @param defaultColour - the colour to set if not exists, or null
+     * @param log - where to say what was wrong with the ball
      * @return
      */
-    static QJsonObject addDefaultsToBall(QJsonObject bData, const char* defaultColour = "white");
+    static QJsonObject addDefaultsToBall(QJsonObject bData, const char* defaultColour = "white", std::ostream& log = std::cerr);
 
     /**
      * @brief ballWithinTable - return whether the ball is within the table's bounds
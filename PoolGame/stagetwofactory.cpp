@@ -32,6 +32,16 @@ Ball* StageTwoFactory::makeBall(const QJsonObject& ballData) {
     return new CompositeBall(col, QVector2D(xpos, ypos), QVector2D(xvel, yvel), mass, radius, strength);
 }
 
+BallNode StageTwoFactory::makeBallNode(const QJsonObject &ballData) {
+    // nested balls never keep their velocity, they get a new one when they break out
+    QJsonObject tPos = ballData.value("position").toObject();
+    QVector2D pos(tPos.value("x").toDouble(), tPos.value("y").toDouble());
+
+    return BallNode{QColor(ballData.value("colour").toString()), pos,
+                    ballData.value("mass").toDouble(), (int) ballData.value("radius").toDouble(),
+                    ballData.value("strength").toDouble(), -1, 1, NoBehaviour};
+}
+
 Table* StageTwoFactory::makeTable(const QJsonObject& tableData) {
 
     // create a stage one table based on the fed in json data
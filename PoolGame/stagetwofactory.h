@@ -15,6 +15,13 @@ public:
      */
     virtual Ball* makeBall(const QJsonObject& ballData) override;
 
+    /**
+     * @brief makeBallNode - construct a nested ball's blueprint based on json
+     * @param ballData - our json data for this ball
+     * @return
+     */
+    virtual BallNode makeBallNode(const QJsonObject& ballData) override;
+
     /**
      * @brief makeTable - construct a table based on json
      * @param tableData - our json data for this table
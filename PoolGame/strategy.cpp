@@ -6,12 +6,11 @@ Strategy *NoStrategy::switchMode()
 }
 
 
-CueBall* AidStrategy::findCue(){
+Ball* AidStrategy::findCue() const{
     for (int i = 0; i < m_balls->size();i++) {
         Ball* ball = m_balls->at(i);
         if(ball->isCue()){
-            CueBall* cue = static_cast<CueBall*> (ball);
-            return cue;
+            return ball;
         }
     }
     return NULL;
@@ -19,21 +18,39 @@ CueBall* AidStrategy::findCue(){
 
 void AidStrategy::update(){
     Ball* cue = findCue();
+    if(cue == NULL){
+        return;
+    }
     Ball* candidB = 0;// Candidate Ball
     Pocket* candidP = 0;// Candidate Pocket
     double max_dot = 0; // maximum dot product
-    for(int i = 0; i < m_balls->size(); i++){
+
+    // gather everything that could be in the way, once per update
+    size_t c = 0;
+    m_ballCircles.clear();
+    m_ballCircles.reserve(m_balls->size());
+    for(size_t i = 0; i < m_balls->size(); i++){
+        Ball* ball = m_balls->at(i);
+        if(ball == cue) c = i;
+        m_ballCircles.add(ball->position(), ball->getRadius());
+    }
+    m_pocketCircles.clear();
+    for(Pocket* pocket : *m_pockets){
+        m_pocketCircles.add(Vector(pocket->pos()), pocket->radius());
+    }
+
+    for(size_t i = 0; i < m_balls->size(); i++){
         Ball* ballA = m_balls->at(i);
         //skip if target ball is cue ball
         if(ballA->isCue()){
             continue;
         }
         //if there are other balls or pockets in between of target ball and cue ball
-        if(!checkBall(ballA, cue)){
+        if(!checkBall(i, c)){
             continue;
         }
         //find the pocket with smallest angle adjustment
-        Pocket* pocket = findPocket(ballA, cue);
+        Pocket* pocket = findPocket(i, cue);
         // skip if the angle is over 90 degree
         if(pocket == 0){
             continue;
@@ -62,15 +79,13 @@ void AidStrategy::update(){
     }
 }
 
-void AidStrategy::render(QPainter &painter)
+void AidStrategy::render(QPainter &painter) const
 {
     if(toCue.length() != 0){
         //draw the line from cue ball current position to desired position
         Ball* cue = findCue();
-        QPen pen = QPen(Qt::DashLine);
-        QColor white(Qt::white);
-        pen.setColor(white);
-        painter.setPen(pen);
+        QPen oldPen = painter.pen();
+        painter.setPen(m_pathPen);
         painter.drawLine(cue->getPosition().toPointF(), toCue.toPointF());
 
         //draw the line for target ball's desired direction
@@ -78,11 +93,10 @@ void AidStrategy::render(QPainter &painter)
         QVector2D endPoint = toCue + AP;
         painter.drawLine(toCue.toPointF(), endPoint.toPointF());
 
-        //draw the cue ball in desired position
-        white.setAlphaF(0);
-        painter.setBrush(QBrush(white));
+        //draw the cue ball in desired position (just its outline)
+        painter.setBrush(m_ghostBrush);
         painter.drawEllipse(toCue.toPointF(),cue->getRadius(),cue->getRadius());
-        painter.setPen(Qt::SolidLine);
+        painter.setPen(oldPen);
 
     }
 }
@@ -106,13 +120,13 @@ QVector2D AidStrategy::calculateC2 (Ball* ballA, Ball* cue, Pocket* pocket){
     return posC2;
 }
 
-Pocket* AidStrategy::findPocket(Ball* ballA, Ball* cue){
+Pocket* AidStrategy::findPocket(size_t a, Ball* cue){
     Pocket* candid = 0;// candidate pocket
     double max_dot = 0;// if the angle is over 90 degree, it's impossible to sink the ball
 
     for(Pocket* pocket : *m_pockets){
-        if(checkPocket(ballA, pocket)){
-            double dot = calculateDot(ballA, cue, pocket);
+        if(checkPocket(a, pocket)){
+            double dot = calculateDot(m_balls->at(a), cue, pocket);
             if(dot > max_dot){
                 max_dot = dot;
                 candid = pocket;
@@ -135,70 +149,28 @@ double AidStrategy::calculateDot(Ball* ballA, Ball* cue, Pocket* pocket){
     return dot;
 }
 
-bool AidStrategy::checkBall(Ball* ballA, Ball* cue){
-    bool noCllide = true;
-    QVector2D posA = ballA->getPosition();
-    QVector2D posC = cue->getPosition();
-    int radiusC = cue->getRadius();
-    //check the intersection wit hother balls
-    for(int i = 0; i < m_balls->size(); i++){
-        Ball* ballB = m_balls->at(i);
-        if(ballB == ballA || ballB == cue){
-            continue;
-        }
-        QVector2D posB = ballB->getPosition();// other ball's position
-        if(minimum_distance(posA, posC, posB) <= radiusC + ballB->getRadius()){
-            noCllide = false;
-            break;
-        }
+bool AidStrategy::checkBall(size_t a, size_t c){
+    const Vector& posA = m_balls->at(a)->position();
+    const Vector& posC = m_balls->at(c)->position();
+    Real radiusC = m_balls->at(c)->getRadius();
+    //check the intersection with other balls (the two ends of the line don't count)
+    size_t hits = m_ballCircles.segmentHits(posA, posC, radiusC, m_mask);
+    if(hits - m_mask[a] - m_mask[c] > 0){
+        return false;
     }
     //check if the cue ball will sink before hit the target ball
-    for(Pocket* pocket : *m_pockets){
-        QVector2D posP = pocket->pos();
-        if(minimum_distance(posA, posC, posP) <= pocket->radius() - radiusC){
-            noCllide = false;
-            break;
-        }
-    }
-    return noCllide;
+    return m_pocketCircles.segmentHits(posA, posC, -radiusC, m_mask) == 0;
 }
 
-bool AidStrategy::checkPocket(Ball* ballA, Pocket* pocket){
-    bool noCllide = true;
-    QVector2D posA = ballA->getPosition();
-    QVector2D posP = pocket-> pos();
-    int radiusA = ballA->getRadius();
+bool AidStrategy::checkPocket(size_t a, Pocket* pocket){
+    const Vector& posA = m_balls->at(a)->position();
+    Vector posP(pocket->pos());
+    int radiusA = m_balls->at(a)->getRadius();
     if(pocket->radius() < radiusA){
         return false;
     }
 
     //check the if there's any ball between the target ball and the pocket
-    for(int i = 0; i < m_balls->size(); i++){
-        Ball* ballB = m_balls->at(i);
-        if(ballB == ballA){
-            continue;
-        }
-
-        QVector2D posB = ballB->getPosition();
-        if(minimum_distance(posA, posP, posB) <= radiusA + ballB->getRadius()){
-            noCllide = false;
-            break;
-        }
-    }
-    return noCllide;
+    size_t hits = m_ballCircles.segmentHits(posA, posP, radiusA, m_mask);
+    return hits - m_mask[a] == 0;
 }
-
-//Obtained from https://stackoverflow.com/a/1501725
-float AidStrategy::minimum_distance(QVector2D v, QVector2D w, QVector2D p) {
-  // Return minimum distance between line segment vw and point p
-  const float l2 = (w-v).lengthSquared();  // i.e. |w-v|^2 -  avoid a sqrt
-  if (l2 == 0.0) return p.distanceToPoint(v);   // v == w case
-  // Consider the line extending the segment, parameterized as v + t (w - v).
-  // We find projection of point p onto the line.
-  // It falls where t = [(p-v) . (w-v)] / |w-v|^2
-  // We clamp t from [0,1] to handle points outside the segment vw.
-  const float t = fmax(0, fmin(1, QVector2D::dotProduct(p - v, w - v) / l2));
-  const QVector2D projection = v + t * (w - v);  // Projection falls on the segment
-  return p.distanceToPoint(projection);
-}
-
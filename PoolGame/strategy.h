@@ -1,6 +1,7 @@
 #pragma once
 #include "table.h"
-#include "balldecorator.h"
+#include "ball.h"
+#include "occlusion.h"
 /**
  * @brief The Strategy class defines the interface for different strategies to run the game
  */
@@ -18,7 +19,7 @@ public:
     /**
      * @brief render additional graphics for the game
      */
-    virtual void render(QPainter& painter) = 0;
+    virtual void render(QPainter& painter) const = 0;
 
     /**
      * @return a copy of strategy with current type
@@ -30,6 +31,11 @@ public:
      */
     virtual Strategy* switchMode() = 0;
 
+    /**
+     * @return whether this strategy shows the player a visual aid
+     */
+    virtual bool aids() const { return false; }
+
 protected:
     std::vector<Ball*>* m_balls;
     std::vector<Pocket*>* m_pockets;
@@ -42,7 +48,7 @@ class NoStrategy : public Strategy{
 public:
     NoStrategy(std::vector<Ball*>* balls, std::vector<Pocket*>* pockets): Strategy(balls, pockets){}
     void update() override{}
-    void render(QPainter&) override{}
+    void render(QPainter&) const override{}
     Strategy* clone(std::vector<Ball*>* balls, std::vector<Pocket*>* pockets) override {return new NoStrategy(balls, pockets);}
     Strategy* switchMode() override;
 };
@@ -53,7 +59,10 @@ public:
  */
 class AidStrategy : public Strategy{
 public:
-    AidStrategy(std::vector<Ball*>* balls, std::vector<Pocket*>* pockets): Strategy(balls, pockets){}
+    AidStrategy(std::vector<Ball*>* balls, std::vector<Pocket*>* pockets): Strategy(balls, pockets),
+        m_pathPen(Qt::DashLine), m_ghostBrush(Qt::NoBrush){
+        m_pathPen.setColor(Qt::white);
+    }
     /**
      * @brief calculates the angle of chooting the cue ball
      */
@@ -62,9 +71,10 @@ public:
     /**
      * @brief render the path of shooting
      */
-    void render(QPainter& painter) override;
+    void render(QPainter& painter) const override;
     Strategy* clone(std::vector<Ball*>* balls, std::vector<Pocket*>* pockets) override {return new AidStrategy(balls, pockets);}
     Strategy* switchMode() override;
+    bool aids() const override { return true; }
 private:
     /**
      * @brief calculateC2 - the desired position for cue ball after shooting
@@ -77,11 +87,11 @@ private:
 
     /**
      * @brief findPocket - finds the best pocket to sink target ball
-     * @param ballA - the target ball to sink
+     * @param a - index of the target ball to sink
      * @param cue - the cue ball
      * @return the pocket with samllest angle adjustment of pocket - target ball - cue ball
      */
-    Pocket *findPocket(Ball *ballA, Ball *cue);
+    Pocket *findPocket(size_t a, Ball *cue);
 
     /**
      * @brief calculateDot - calculate CA dot product AP
@@ -94,33 +104,37 @@ private:
 
     /**
      * @brief checkBall - check the if there's any ball or pocket intersect CA line
-     * @param ballA - A
-     * @param cue - C
+     * @param a - index of A
+     * @param c - index of C
      * @return true if there's no any intersection, false otherwise
      */
-    bool checkBall(Ball *ballA, Ball *cue);
+    bool checkBall(size_t a, size_t c);
 
     /**
      * @brief checkPocket - check if there's any ball intersect AP line
-     * @param ballA - A
+     * @param a - index of A
      * @param pocket - P
      * @return true if there's no any intersection, false otherwise
      */
-    bool checkPocket(Ball *ballA, Pocket *pocket);
-
-    /**
-     * @brief minimum_distance find the minumum distance from Point P to line VW
-     */
-    float minimum_distance(QVector2D v, QVector2D w, QVector2D p);
+    bool checkPocket(size_t a, Pocket *pocket);
 
     /**
      * @brief findCue - find the cue ball from all the balls
      * @return the cue ball
      */
-    CueBall *findCue();
+    Ball *findCue() const;
 
 private:
     QVector2D toCue; // the desired cue position after shooting
 
     Pocket* toPocket = 0; //the wanted pocket to sink the ball
+
+    // what the path is drawn with, made once rather than every frame
+    QPen m_pathPen;
+    QBrush m_ghostBrush;
+
+    // the balls & pockets of this update, to test every line against all of them at once
+    CircleSet m_ballCircles;
+    CircleSet m_pocketCircles;
+    std::vector<unsigned char> m_mask;
 };
@@ -0,0 +1,184 @@
+/**
+ * streamcheck - check the event stream. First on one thread (capacity, wrapping around, dropping the oldest
+ *  events), then with a writer publishing as fast as it can while readers on other threads, some of them slow,
+ *  poll it. Every event carries its own index in every field, so a torn copy, a repeat or one out of order
+ *  shows up, and every event has to be either read or counted as dropped. Fails if anything is off
+ *  e.g. streamcheck --events 2000000 --readers 4
+ */
+
+#include "eventstream.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/* the event with the index, every field of it different and worked out from the index */
+static PhysicsEvent numbered(uint64_t index) {
+    PhysicsEvent e;
+    e.type = PhysicsEvent::Type(index % PhysicsEvent::TypeCount);
+    e.ball = PhysicsEvent::Subject{int(index & 0xffffff), QVector2D(index % 4096, (index / 4096) % 4096), double(index)};
+    e.other = PhysicsEvent::Subject{~int(index & 0xffffff), QVector2D((index / 4096) % 4096, index % 4096), -double(index)};
+    return e;
+}
+
+/* the index of the event, or -1 if it isn't all from the same one */
+static int64_t indexOf(const PhysicsEvent& e) {
+    const uint64_t index = uint64_t(e.ball.deltaV);
+    const PhysicsEvent expected = numbered(index);
+    const bool same = e.type == expected.type && e.ball.behaviours == expected.ball.behaviours
+            && e.ball.position == expected.ball.position && e.other.behaviours == expected.other.behaviours
+            && e.other.position == expected.other.position && e.other.deltaV == expected.other.deltaV;
+    return same ? int64_t(index) : -1;
+}
+
+/* publish the next count events, numbered from next */
+static void publish(EventStream& stream, uint64_t& next, size_t count, std::vector<PhysicsEvent>& batch) {
+    batch.clear();
+    for (size_t i = 0; i < count; ++i) batch.push_back(numbered(next++));
+    stream.publish(batch);
+}
+
+static bool check(bool passed, const char* what) {
+    std::cout << (passed ? "ok     " : "FAILED ") << what << std::endl;
+    return passed;
+}
+
+/**
+ * @brief checkSingleThread - capacity, subscribing, polling a few at a time, and wrapping around
+ */
+static bool checkSingleThread() {
+    bool passed = true;
+    passed &= check(EventStream(5).capacity() == 8 && EventStream(0).capacity() == 1, "capacity rounds up to a power of two");
+
+    std::shared_ptr<EventStream> stream = std::make_shared<EventStream>(8);
+    std::vector<PhysicsEvent> batch, out;
+    uint64_t next = 0;
+    publish(*stream, next, 3, batch);
+    EventStream::Subscriber sub = stream->subscribe();
+    sub.poll(out);
+    passed &= check(out.empty(), "subscribers start from the next event published");
+
+    publish(*stream, next, 5, batch);
+    const size_t first = sub.poll(out, 2);
+    const size_t rest = sub.poll(out);
+    passed &= check(first == 2 && rest == 3 && out.size() == 5 && indexOf(out.front()) == 3 && indexOf(out.back()) == 7,
+                    "polling takes at most max events, and carries on from there");
+
+    // 20 more through 8 slots, so only the last 8 are left
+    out.clear();
+    publish(*stream, next, 20, batch);
+    sub.poll(out);
+    passed &= check(out.size() == 8 && indexOf(out.front()) == 20 && indexOf(out.back()) == 27 && sub.dropped() == 12,
+                    "falling behind drops the oldest events, and counts them");
+
+    out.clear();
+    publish(*stream, next, 3, batch);
+    sub.poll(out);
+    passed &= check(out.size() == 3 && indexOf(out.front()) == 28 && sub.dropped() == 12 && stream->published() == 31,
+                    "and carries on after wrapping around");
+    return passed;
+}
+
+/**
+ * @brief The Reader struct - a subscriber polling on its own thread
+ */
+struct Reader {
+    EventStream::Subscriber sub;
+    // how long to wait between polls, to fall behind on purpose
+    std::chrono::microseconds pause;
+    uint64_t received = 0;
+    bool torn = false;
+    bool outOfOrder = false;
+    bool unaccounted = false;
+
+    Reader(const EventStream::Subscriber& sub, std::chrono::microseconds pause) : sub(sub), pause(pause) {}
+
+    void run(const std::atomic<bool>& done) {
+        std::vector<PhysicsEvent> out;
+        int64_t last = -1;
+        for (;;) {
+            // everything is published once done is set, so a poll after that gets the rest
+            const bool finished = done.load(std::memory_order_acquire);
+            out.clear();
+            sub.poll(out);
+            for (const PhysicsEvent& e : out) {
+                const int64_t index = indexOf(e);
+                torn |= index < 0;
+                outOfOrder |= index >= 0 && index <= last;
+                last = std::max(last, index);
+            }
+            received += out.size();
+            // everything up to the last one read was either read or dropped
+            unaccounted |= int64_t(received + sub.dropped()) < last + 1;
+            if (finished && out.empty()) return;
+            if (pause.count() > 0) std::this_thread::sleep_for(pause);
+        }
+    }
+};
+
+/**
+ * @brief checkThreads - one writer, and readers on their own threads
+ * @param events - how many events to publish
+ * @param readers - how many readers, every other one is slow
+ */
+static bool checkThreads(uint64_t events, int readers) {
+    std::shared_ptr<EventStream> stream = std::make_shared<EventStream>(1024);
+    std::vector<Reader> state;
+    for (int r = 0; r < readers; ++r) {
+        state.push_back(Reader(stream->subscribe(), std::chrono::microseconds(r % 2 == 0 ? 0 : 500)));
+    }
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+    for (Reader& r : state) threads.emplace_back([&r, &done] { r.run(done); });
+
+    // batches of every size up to a few times around the ring
+    std::vector<PhysicsEvent> batch;
+    uint64_t next = 0;
+    for (size_t size = 1; next < events; size = size % 3000 + 1) {
+        publish(*stream, next, std::min<uint64_t>(size, events - next), batch);
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+
+    bool torn = false, outOfOrder = false, unaccounted = false, total = true;
+    for (const Reader& r : state) {
+        std::cout << "        reader read " << r.received << ", dropped " << r.sub.dropped() << std::endl;
+        torn |= r.torn;
+        outOfOrder |= r.outOfOrder;
+        unaccounted |= r.unaccounted;
+        total &= r.received + r.sub.dropped() == events;
+    }
+    bool passed = true;
+    passed &= check(!torn, "readers never see a torn event");
+    passed &= check(!outOfOrder, "readers see events in order, once");
+    passed &= check(!unaccounted && total, "every event is either read or counted as dropped");
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("streamcheck");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Check the event stream, with readers on their own threads");
+    parser.addHelpOption();
+    QCommandLineOption eventsOpt("events", "Events to publish", "count", "2000000");
+    QCommandLineOption readersOpt("readers", "Reader threads, every other one slow", "count", "4");
+    parser.addOptions({eventsOpt, readersOpt});
+    parser.process(app);
+
+    const uint64_t events = parser.value(eventsOpt).toULongLong();
+    const int readers = parser.value(readersOpt).toInt();
+    if (events == 0 || readers <= 0) {
+        std::cerr << "invalid arguments\n";
+        parser.showHelp(1);
+    }
+
+    bool passed = checkSingleThread();
+    passed &= checkThreads(events, readers);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Checks the event stream, with a writer & readers on their own threads
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = streamcheck
+TEMPLATE = app
+CONFIG += console thread
+CONFIG -= app_bundle
+# a test, so make check builds it and runs it
+CONFIG += testcase
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        main.cpp \
+    ../eventstream.cpp
+
+HEADERS += \
+    ../eventstream.h
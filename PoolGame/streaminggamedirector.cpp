@@ -0,0 +1,345 @@
+#include "streaminggamedirector.h"
+#include <QtConcurrent>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+Game* StreamingGameDirector::createGame() {
+    if (m_reader.next() != JsonPullReader::BeginObject) return nullptr;
+
+    bool ok = true;
+    for (JsonPullReader::Token t = m_reader.next(); ok && t != JsonPullReader::EndObject; t = m_reader.next()) {
+        if (t != JsonPullReader::Key) {
+            ok = false;
+            break;
+        }
+        const std::string key = m_reader.text();
+        if (key == "stage2" || key == "stage3") {
+            t = m_reader.next();
+            bool& stage = key == "stage2" ? m_stageTwo : m_stageThree;
+            stage = t == JsonPullReader::Bool && m_reader.boolean();
+            ok = m_reader.skip(t);
+        } else if (key == "table") {
+            // like a json document, the last of a repeated key wins
+            delete m_table;
+            m_table = nullptr;
+            t = m_reader.next();
+            ok = t == JsonPullReader::BeginObject ? readTable() : m_reader.skip(t);
+        } else if (key == "localStepping") {
+            t = m_reader.next();
+            m_localStepping = t == JsonPullReader::Bool && m_reader.boolean();
+            ok = m_reader.skip(t);
+        } else if (key == "spawn") {
+            double spawn = 0;
+            bool valid;
+            ok = readNumber(spawn, valid);
+            if (valid && spawn > 0) m_spawn = size_t(spawn);
+        } else if (key == "balls") {
+            ok = readBalls();
+        } else {
+            ok = m_reader.skipValue();
+        }
+    }
+
+    // leave anything that isn't a valid stage two config to the GameDirector
+    // nothing but whitespace can come after the config
+    ok = ok && m_reader.next() == JsonPullReader::EndOfDocument;
+    if (!ok || !m_stageTwo) {
+        for (Ball* b : m_balls) delete b;
+        m_balls.clear();
+        delete m_table;
+        m_table = nullptr;
+        return nullptr;
+    }
+
+    if (m_table == nullptr) {
+        std::cerr << "no table supplied...\n";
+        QJsonObject defaultTable;
+        m_builder.addTable(defaultTable);
+    } else {
+        m_builder.addBuiltTable(m_table);
+        m_table = nullptr;
+    }
+    // now the table is known, balls off of the table can be rejected
+    for (Ball* b : m_balls) m_builder.addBuiltBall(b);
+    m_balls.clear();
+
+    Game* game = m_builder.getResult();
+    if (m_stageThree) game->setStageThree();
+    game->setLocalStepping(m_localStepping);
+    game->addRandomBalls(m_spawn);
+    return game;
+}
+
+bool StreamingGameDirector::readNumber(double &v, bool &valid) {
+    JsonPullReader::Token t = m_reader.next();
+    valid = t == JsonPullReader::Number;
+    if (valid) v = m_reader.number();
+    return m_reader.skip(t);
+}
+
+bool StreamingGameDirector::readColour(QColor &colour, bool &valid) {
+    JsonPullReader::Token t = m_reader.next();
+    valid = false;
+    if (t == JsonPullReader::String) {
+        QColor c(QString::fromUtf8(m_reader.text().c_str()));
+        valid = c.isValid();
+        if (valid) colour = c;
+    }
+    return m_reader.skip(t);
+}
+
+bool StreamingGameDirector::readVector(double &x, double &y, bool &valid) {
+    JsonPullReader::Token t = m_reader.next();
+    if (t != JsonPullReader::BeginObject) {
+        valid = false;
+        return m_reader.skip(t);
+    }
+
+    bool hasX = false, hasY = false;
+    for (t = m_reader.next(); t != JsonPullReader::EndObject; t = m_reader.next()) {
+        if (t != JsonPullReader::Key) return false;
+        bool isValid = true;
+        if (m_reader.text() == "x") {
+            if (!readNumber(x, isValid)) return false;
+            hasX = isValid;
+        } else if (m_reader.text() == "y") {
+            if (!readNumber(y, isValid)) return false;
+            hasY = isValid;
+        } else if (!m_reader.skipValue()) {
+            return false;
+        }
+    }
+    valid = hasX && hasY;
+    return true;
+}
+
+bool StreamingGameDirector::readTable() {
+    // default table is 600x300, green, with a friction of 0.01
+    double width = 600.0, height = 300.0;
+    QColor colour("green");
+    double friction = 0.01;
+    // pockets can only be checked once we know the size
+    struct PocketData { double radius; double x; double y; bool hasPosition; };
+    std::vector<PocketData> pockets;
+
+    for (JsonPullReader::Token t = m_reader.next(); t != JsonPullReader::EndObject; t = m_reader.next()) {
+        if (t != JsonPullReader::Key) return false;
+        const std::string key = m_reader.text();
+        bool valid = true;
+        if (key == "size") {
+            double x = DOUBLEINF, y = DOUBLEINF;
+            if (!readVector(x, y, valid)) return false;
+            if (x == DOUBLEINF) std::cerr << "invalid table width!\n";
+            else width = x;
+            if (y == DOUBLEINF) std::cerr << "invalid table height!\n";
+            else height = y;
+        } else if (key == "colour") {
+            if (!readColour(colour, valid)) return false;
+            if (!valid) std::cerr << "invalid table colour\n";
+        } else if (key == "friction") {
+            if (!readNumber(friction, valid)) return false;
+            if (!valid) std::cerr << "invalid friction supplied.\n";
+        } else if (key == "pockets") {
+            t = m_reader.next();
+            if (t != JsonPullReader::BeginArray) {
+                if (!m_reader.skip(t)) return false;
+                continue;
+            }
+            for (t = m_reader.next(); t != JsonPullReader::EndArray; t = m_reader.next()) {
+                if (t != JsonPullReader::BeginObject) {
+                    if (!m_reader.skip(t)) return false;
+                    continue;
+                }
+                // default radius = 15
+                PocketData p{15.0, DOUBLEINF, DOUBLEINF, false};
+                for (t = m_reader.next(); t != JsonPullReader::EndObject; t = m_reader.next()) {
+                    if (t != JsonPullReader::Key) return false;
+                    if (m_reader.text() == "radius") {
+                        if (!readNumber(p.radius, valid)) return false;
+                        if (!valid) p.radius = DOUBLEINF;
+                    } else if (m_reader.text() == "position") {
+                        if (!readVector(p.x, p.y, valid)) return false;
+                        p.hasPosition = true;
+                    } else if (!m_reader.skipValue()) {
+                        return false;
+                    }
+                }
+                pockets.push_back(p);
+            }
+        } else if (!m_reader.skipValue()) {
+            return false;
+        }
+    }
+
+    StageTwoTable* table = new StageTwoTable(width, height, colour, friction);
+    for (const PocketData& p : pockets) {
+        // skip invalid pockie
+        if (!p.hasPosition || !StageTwoBuilder::isValidPocket(p.x, p.y, p.radius, width, height)) continue;
+        table->addPocket(new Pocket(p.radius, QVector2D(p.x, p.y)));
+    }
+    m_table = table;
+    return true;
+}
+
+bool StreamingGameDirector::readBalls() {
+    JsonPullReader::Token t = m_reader.next();
+    // like a json document, a repeated key replaces the balls read before it
+    for (Ball* b : m_balls) delete b;
+    m_balls.clear();
+    if (t != JsonPullReader::BeginArray) return m_reader.skip(t);
+
+    for (t = m_reader.next(); t != JsonPullReader::EndArray; t = m_reader.next()) {
+        if (t != JsonPullReader::BeginObject) {
+            if (!m_reader.skip(t)) return false;
+            continue;
+        }
+        m_nodes.clear();
+        m_radii.clear();
+        QVector2D velocity;
+        if (!readBall(-1, velocity)) return false;
+        m_read.push_back(ReadBall{m_nodes, m_radii, velocity});
+        if (m_read.size() >= BatchSize) finishBalls();
+    }
+    finishBalls();
+    return true;
+}
+
+void StreamingGameDirector::finishBalls() {
+    if (!m_builder.m_parallel || m_read.size() < size_t(StageTwoBuilder::ParallelThreshold)) {
+        for (const ReadBall& read : m_read) m_balls.push_back(finishBall(read, std::cerr));
+    } else {
+        // what was wrong with each ball is printed once they're back in order, so it doesn't interleave
+        std::function<StageTwoBuilder::BuiltBall(const ReadBall&)> finish = [](const ReadBall& read) {
+            std::ostringstream log;
+            Ball* ball = finishBall(read, log);
+            return StageTwoBuilder::BuiltBall{ball, log.str()};
+        };
+        QVector<StageTwoBuilder::BuiltBall> built =
+                QtConcurrent::blockingMapped<QVector<StageTwoBuilder::BuiltBall>>(m_read, finish);
+        for (const StageTwoBuilder::BuiltBall& b : built) {
+            std::cerr << b.messages;
+            m_balls.push_back(b.ball);
+        }
+    }
+    m_read.clear();
+}
+
+bool StreamingGameDirector::readBall(int parent, QVector2D &velocity) {
+    // defaults: colour is inherited (set once known), mass 1, radius 10, unbreakable, at rest at the origin
+    const int self = m_nodes.size();
+    m_nodes.push_back(BallNode{QColor(), QVector2D(), 1.0, 10, DOUBLEINF, parent, 1, NoBehaviour});
+    m_radii.push_back(10.0);
+
+    for (JsonPullReader::Token t = m_reader.next(); t != JsonPullReader::EndObject; t = m_reader.next()) {
+        if (t != JsonPullReader::Key) return false;
+        const std::string key = m_reader.text();
+        bool valid = true;
+        // careful, m_nodes may be reallocated whilst reading children
+        if (key == "colour") {
+            QColor colour;
+            if (!readColour(colour, valid)) return false;
+            if (!valid) {
+                std::cerr << "invalid ball colour supplied\n";
+                colour = QColor("white");
+            }
+            m_nodes[self].colour = colour;
+        } else if (key == "mass") {
+            double mass = 0;
+            if (!readNumber(mass, valid)) return false;
+            if (!valid || mass <= 0) std::cerr << "invalid ball mass\n";
+            else m_nodes[self].mass = mass;
+        } else if (key == "strength") {
+            double strength = 0;
+            if (!readNumber(strength, valid)) return false;
+            if (!valid || strength <= 0) std::cerr << "invalid strength\n";
+            else m_nodes[self].strength = strength;
+        } else if (key == "radius") {
+            double radius = 0;
+            if (!readNumber(radius, valid)) return false;
+            if (!valid || radius <= 0) {
+                std::cerr << "invalid radius\n";
+            } else {
+                m_nodes[self].radius = radius;
+                m_radii[self] = radius;
+            }
+        } else if (key == "velocity" || key == "position") {
+            double x = DOUBLEINF, y = DOUBLEINF;
+            if (!readVector(x, y, valid)) return false;
+            if (x == DOUBLEINF) {
+                std::cerr << "invalid x" << key << "\n";
+                x = 0.0;
+            }
+            if (y == DOUBLEINF) {
+                std::cerr << "invalid y" << key << "\n";
+                y = 0.0;
+            }
+            if (key == "velocity") velocity = QVector2D(x, y);
+            else m_nodes[self].offset = QVector2D(x, y);
+        } else if (key == "balls") {
+            t = m_reader.next();
+            if (t != JsonPullReader::BeginArray) {
+                if (!m_reader.skip(t)) return false;
+                continue;
+            }
+            for (t = m_reader.next(); t != JsonPullReader::EndArray; t = m_reader.next()) {
+                if (t != JsonPullReader::BeginObject) {
+                    if (!m_reader.skip(t)) return false;
+                    continue;
+                }
+                // nested balls never keep their velocity
+                QVector2D ignored;
+                if (!readBall(self, ignored)) return false;
+            }
+        } else if (!m_reader.skipValue()) {
+            return false;
+        }
+    }
+    m_nodes[self].subtreeSize = m_nodes.size() - self;
+    return true;
+}
+
+Ball* StreamingGameDirector::finishBall(const ReadBall &read, std::ostream &log) {
+    const std::vector<BallNode>& nodes = read.nodes;
+    BallNode root = nodes.front();
+    // default colour is white
+    if (!root.colour.isValid()) root.colour = QColor("white");
+
+    // a child's colour & bounds depend on its parent, which may have only been read after it,
+    // so they're resolved now. preorder means parents are always resolved before their children
+    std::shared_ptr<BallBlueprint> blueprint;
+    if (nodes.size() > 1) blueprint = std::make_shared<BallBlueprint>();
+    std::vector<int> remap(nodes.size(), -1);
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        BallNode node = nodes[i];
+        const bool isDirectChild = node.parent == 0;
+        // whole subtree is dropped with its parent
+        if (!isDirectChild && remap[node.parent] == -1) continue;
+        const BallNode& parent = isDirectChild ? root : blueprint->at(remap[node.parent]);
+
+        // ignore if outside of parent ball (before the radii are rounded, like the GameDirector)
+        const double parentRadius = read.radii[isDirectChild ? 0 : node.parent], radius = read.radii[i];
+        if (!(parentRadius >= radius + node.offset.x() && parentRadius >= radius + node.offset.y())) {
+            if (isDirectChild) log << "invalid child ball, ignoring\n";
+            continue;
+        }
+        if (!node.colour.isValid()) node.colour = parent.colour;
+        if (!isDirectChild) node.offset += parent.offset;
+        node.parent = isDirectChild ? -1 : remap[node.parent];
+        node.subtreeSize = 1;
+
+        remap[i] = blueprint->size();
+        blueprint->push_back(node);
+    }
+
+    CompositeBall* ball = new CompositeBall(root.colour, root.offset, read.velocity, root.mass, root.radius, root.strength);
+    if (blueprint) {
+        // the dropped subtrees need to be taken out of the sizes
+        for (size_t j = blueprint->size(); j-- > 0;) {
+            const int parent = blueprint->at(j).parent;
+            if (parent != -1) blueprint->at(parent).subtreeSize += blueprint->at(j).subtreeSize;
+        }
+        ball->setChildren(blueprint);
+    }
+    return ball;
+}
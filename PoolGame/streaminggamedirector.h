@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QIODevice>
+#include "jsonpullreader.h"
+#include "stagetwobuilder.h"
+
+/**
+ * @brief The StreamingGameDirector class
+ * Builds a stage two game straight from a config stream, in a single pass.
+ *  Unlike the GameDirector, no json DOM is ever built: defaults and validation are applied as each
+ *  value is read, and balls are written straight into the game's storage. Besides the game itself,
+ *  memory use only grows with how deeply the config is nested (and a batch of balls).
+ *
+ * Reading is a single pass, but checking a ball's children and creating it isn't: balls are read into
+ *  batches, and large batches are finished on the thread pool, then merged back in the order they were read.
+ */
+class StreamingGameDirector {
+public:
+    StreamingGameDirector(QIODevice* device) : m_reader(device) {}
+
+    /**
+     * @brief createGame - read the config and build the game from it
+     * @return the newly created game, or nullptr if the config is malformed or isn't a stage two config
+     */
+    Game* createGame();
+
+    /* whether the config turned on stage three (only valid once the game has been created) */
+    bool isStageThree() const { return m_stageThree; }
+
+private:
+    JsonPullReader m_reader;
+    StageTwoBuilder m_builder;
+    bool m_stageTwo = false;
+    bool m_stageThree = false;
+    // whether fast balls take substeps of their own, see Game::setLocalStepping
+    bool m_localStepping = false;
+    // how many random balls to add on top of the config's own
+    size_t m_spawn = 0;
+
+    // the balls read so far, they can only be checked against the table at the end
+    std::vector<Ball*> m_balls;
+    Table* m_table = nullptr;
+
+    // scratch space for the ball currently being read. node 0 is the top level ball, positions are local
+    std::vector<BallNode> m_nodes;
+    // the radius of each node as it was read, children are checked against these before they're rounded
+    std::vector<double> m_radii;
+
+    // a top level ball that has been read, but not created yet
+    struct ReadBall {
+        std::vector<BallNode> nodes;
+        std::vector<double> radii;
+        QVector2D velocity;
+    };
+    // most balls read before they are finished
+    static constexpr size_t BatchSize = 1024;
+    std::vector<ReadBall> m_read;
+
+    /* read the table object (its BeginObject has already been read) */
+    bool readTable();
+    /* read the array of balls */
+    bool readBalls();
+    /**
+     * @brief readBall - read a ball object (its BeginObject has already been read) and all of its children into m_nodes (& m_radii)
+     * @param parent - index of the parent in m_nodes, or -1 for the top level ball
+     * @param velocity - set to the ball's velocity
+     */
+    bool readBall(int parent, QVector2D& velocity);
+    /**
+     * @brief finishBalls - create the balls read so far (on the thread pool, if there are enough), in order
+     */
+    void finishBalls();
+    /**
+     * @brief finishBall - validate the children of a ball that was read, and create the top level ball from them.
+     *  safe to call from many threads at once
+     * @param read - the ball's nodes, their radii, and its velocity
+     * @param log - where to say what was wrong with it
+     * @return the ball
+     */
+    static Ball* finishBall(const ReadBall& read, std::ostream& log);
+
+    /**
+     * @brief readNumber - read the value after a key as a number
+     * @param v - set to the number, left alone if the value wasn't a number
+     * @return false if the json is malformed
+     */
+    bool readNumber(double& v, bool& valid);
+    /**
+     * @brief readVector - read an object with x and y values
+     * @param x - set to x, left alone if it isn't a valid number
+     * @param y - set to y, left alone if it isn't a valid number
+     * @param valid - set to whether the value was an object with both x and y
+     * @return false if the json is malformed
+     */
+    bool readVector(double& x, double& y, bool& valid);
+    /**
+     * @brief readColour - read the value after a key as a colour
+     * @param colour - set to the colour, left alone if the value wasn't a valid colour
+     * @return false if the json is malformed
+     */
+    bool readColour(QColor& colour, bool& valid);
+};
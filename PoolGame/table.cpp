@@ -2,14 +2,14 @@
 #include "ball.h"
 #include <iostream>
 
-void StageOneTable::render(QPainter &painter, const QVector2D& offset) {
+void StageOneTable::render(QPainter &painter, const QVector2D& offset, const QRectF&) const {
     // our table colour
     painter.setBrush(m_brush);
     // draw table
     painter.drawRect(offset.x(), offset.y(), this->getWidth(), this->getHeight());
 }
 
-void StageTwoTable::render(QPainter &painter, const QVector2D& offset) {
+void StageTwoTable::render(QPainter &painter, const QVector2D& offset, const QRectF& view) const {
     // our table colour
     painter.setBrush(m_brush);
     // draw table
@@ -17,6 +17,10 @@ void StageTwoTable::render(QPainter &painter, const QVector2D& offset) {
 
     // render the pockets relative to this table
     for (Pocket* p : m_pockets) {
+        // skip the ones out of sight
+        const QPointF centre = (offset + p->pos()).toPointF();
+        const double r = p->radius();
+        if (!view.isNull() && !view.intersects(QRectF(centre.x() - r, centre.y() - r, 2*r, 2*r))) continue;
         p->render(painter, offset);
     }
 }
@@ -31,27 +35,26 @@ StageTwoTable::~StageTwoTable() {
     for (Pocket* p : m_pockets) delete p;
 }
 
-bool StageTwoTable::sinks(Ball *b) {
+Table::Sinking StageTwoTable::sinks(Ball *b, std::mt19937& rng) {
     QVector2D absPos = b->getPosition();
     double radius = b->getRadius();
     // check whether any pockets consumes this ball
     for (Pocket* p : m_pockets) {
         // you sunk my scrabbleship
         if (p->contains(absPos, radius)) {
-            if(b->isCue()){
-                Pocket* p2 = m_pockets.at(rand()% (m_pockets.size() - 1));
-                while(p2 == p){
-                    p2 = m_pockets.at(rand()% (m_pockets.size() - 1));
-                }
+            // the cue ball pops out of any other pocket
+            if(b->isCue() && m_pockets.size() > 1){
+                Pocket* p2 = m_pockets.at(rng() % (m_pockets.size() - 1));
+                if(p2 == p) p2 = m_pockets.back();
                 b->setPosition(p2->pos());
-                QVector2D *v = new QVector2D(rand()%40 - 20, rand()%40 - 20);
-                b->setVelocity((*v) *10);
-                break;
+                QVector2D v(int(rng()%40) - 20, int(rng()%40) - 20);
+                b->setVelocity(v * 10);
+                return Teleported;
             }else{
                 p->incrementSunk();
-                return true;
+                return Sunk;
             }
         }
     }
-    return false;
+    return Missed;
 }
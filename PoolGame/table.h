@@ -2,6 +2,7 @@
 
 #include <QColor>
 #include <QPainter>
+#include <random>
 
 #include "pocket.h"
 #include "visiter.h"
@@ -31,14 +32,25 @@ public:
     /**
      * @brief render - draw the table to screen using the specified painter
      * @param painter - painter to use
+     * @param view - the part of the table that can be seen, a null rect to draw everything
      */
-    virtual void render(QPainter& painter, const QVector2D& offset) = 0;
+    virtual void render(QPainter& painter, const QVector2D& offset, const QRectF& view) const = 0;
 
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     double getFriction() const { return m_friction; }
+    void setFriction(double friction) { m_friction = friction; }
+    QColor getColour() const { return m_brush.color(); }
 
-    virtual bool sinks(Ball*) { return false; }
+    // what happened to a ball that went near a pocket
+    enum Sinking { Missed, Sunk, Teleported };
+
+    /**
+     * @brief sinks - whether the ball gets swallowed by the table
+     * @param rng - the game's random source, i.e. for where the cue ball reappears
+     * @return Sunk if it was swallowed, Teleported if it popped back out of another pocket
+     */
+    virtual Sinking sinks(Ball*, std::mt19937&) { return Missed; }
 
     /**
      * @brief accept - take the visiter and let it access pockets
@@ -62,7 +74,7 @@ public:
      * @brief render - draw the stageonetable to screen using the specified painter
      * @param painter - painter to use
      */
-    void render(QPainter &painter, const QVector2D& offset) override;
+    void render(QPainter &painter, const QVector2D& offset, const QRectF& view) const override;
 };
 
 class StageTwoTable : public Table {
@@ -90,10 +102,10 @@ public:
      * @brief render - draw the stageonetable to screen using the specified painter
      * @param painter - painter to use
      */
-    void render(QPainter &painter, const QVector2D& offset) override;
+    void render(QPainter &painter, const QVector2D& offset, const QRectF& view) const override;
 
     // sinky winky ball
-    virtual bool sinks(Ball* b) override;
+    virtual Sinking sinks(Ball* b, std::mt19937& rng) override;
 
     /* self explanatory */
     void addPocket(Pocket* p) { m_pockets.push_back(p); }
@@ -0,0 +1,44 @@
+#include "tilerenderer.h"
+#include <QPainter>
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+
+void TileRenderer::retile(const QSize &size) {
+    m_image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    m_tiles.clear();
+    for (int y = 0; y < size.height(); y += m_tileSize) {
+        for (int x = 0; x < size.width(); x += m_tileSize) {
+            // the last row & column are cut short by the image's edges
+            m_tiles.push_back(Tile{QRect(x, y, std::min(m_tileSize, size.width() - x),
+                                         std::min(m_tileSize, size.height() - y)), {}});
+        }
+    }
+}
+
+const QImage& TileRenderer::render(Game &game, const Camera &camera, const QSize &size) {
+    if (m_image.size() != size) retile(size);
+    if (m_tiles.empty()) return m_image;
+
+    // everything the tiles need is worked out up front, after that the game is only read
+    game.prepareRender(camera.visible());
+
+    // bits() copies the image if it's shared, so only ever call it here
+    uchar* pixels = m_image.bits();
+    const int stride = m_image.bytesPerLine();
+    const int depth = m_image.depth() / 8;
+    const QImage::Format format = m_image.format();
+
+    std::function<void(Tile&)> draw = [&](Tile& tile) {
+        // a window into the tile's part of the image, sharing its memory
+        QImage part(pixels + tile.rect.y() * stride + tile.rect.x() * depth,
+                    tile.rect.width(), tile.rect.height(), stride, format);
+        part.fill(Qt::transparent);
+        QPainter painter(&part);
+        painter.translate(-tile.rect.x(), -tile.rect.y());
+        camera.apply(painter);
+        game.renderView(painter, camera.toWorld(QRectF(tile.rect)), tile.visible);
+    };
+    QtConcurrent::blockingMap(m_tiles, draw);
+    return m_image;
+}
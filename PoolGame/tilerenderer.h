@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <vector>
+#include "game.h"
+#include "camera.h"
+
+/**
+ * @brief The TileRenderer class
+ * Draws the game into an offscreen image, split into tiles that are drawn in parallel on the thread pool.
+ *  Every tile gets its own painter, over its own window into the image's memory, so the tiles never share
+ *  anything but the (unchanging) game. Without a GPU all drawing is done by the CPU anyway, so this spreads
+ *  it over every core rather than only the GUI thread.
+ */
+class TileRenderer {
+public:
+    /**
+     * @param tileSize - the width & height of a tile, in pixels
+     */
+    TileRenderer(int tileSize = DefaultTileSize) : m_tileSize(tileSize) {}
+
+    /**
+     * @brief render - draw what the camera sees of the game
+     * @param game - the game, it mustn't change until we return
+     * @param camera - what to draw
+     * @param size - the size of the image, i.e. the window
+     * @return the image, valid until the next render
+     */
+    const QImage& render(Game& game, const Camera& camera, const QSize& size);
+
+private:
+    static constexpr int DefaultTileSize = 128;
+
+    struct Tile {
+        // where the tile is, in the image
+        QRect rect;
+        // scratch space for the balls in the tile
+        std::vector<unsigned> visible;
+    };
+
+    int m_tileSize;
+    QImage m_image;
+    std::vector<Tile> m_tiles;
+
+    /* cut the image up into tiles again, when its size changes */
+    void retile(const QSize& size);
+};
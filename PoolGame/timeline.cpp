@@ -0,0 +1,90 @@
+#include "timeline.h"
+#include "scenariocache.h"
+#include <algorithm>
+
+void Timeline::reset(size_t step, Game &game) {
+    // the game at this step is whatever we were given, the old inputs don't lead to it
+    m_inputs.erase(std::remove_if(m_inputs.begin(), m_inputs.end(),
+                                  [step](const Input& i) { return i.step >= step; }), m_inputs.end());
+    forget(step);
+    m_keyframes[step] = Keyframe{ScenarioCache::snapshot(game), true};
+    m_end = step;
+}
+
+void Timeline::stepped(size_t step, Game &game) {
+    m_end = std::max(m_end, step);
+    if (step % m_interval != 0 || m_keyframes.count(step)) return;
+    m_keyframes[step] = Keyframe{ScenarioCache::snapshot(game), false};
+    if (m_keyframes.size() > m_maxKeyframes) thin();
+}
+
+void Timeline::record(const Input &input) {
+    forget(input.step);
+    m_inputs.push_back(input);
+    m_end = input.step;
+}
+
+void Timeline::replay(size_t step, Game &game) const {
+    for (const Input& i : m_inputs) {
+        if (i.step == step) apply(i, game);
+    }
+}
+
+Game* Timeline::seek(size_t step, double dt) const {
+    step = std::min(step, m_end);
+    auto keyframe = m_keyframes.upper_bound(step);
+    if (keyframe == m_keyframes.begin()) return nullptr;
+    --keyframe;
+
+    Game* game = ScenarioCache::restore(keyframe->second.state);
+    if (game == nullptr) return nullptr;
+    // inputs are in order, so skip straight to the keyframe's
+    auto input = std::lower_bound(m_inputs.begin(), m_inputs.end(), keyframe->first,
+                                  [](const Input& i, size_t s) { return i.step < s; });
+    for (size_t s = keyframe->first; s < step; ++s) {
+        for (; input != m_inputs.end() && input->step == s; ++input) apply(*input, *game);
+        game->animate(dt);
+    }
+    return game;
+}
+
+void Timeline::apply(const Input &input, Game &game) {
+    switch (input.type) {
+    case Input::CueShot:
+        if (CueBall* cue = game.findCue()) {
+            cue->ball()->setPosition(input.position);
+            cue->ball()->setVelocity(input.velocity);
+            cue->setSavedPosition(input.position);
+            cue->setStruck();
+        }
+        break;
+    case Input::AddBall:
+        game.addRandomBalls(input.count);
+        break;
+    case Input::SwitchMode:
+        game.switchMode();
+        break;
+    }
+}
+
+void Timeline::forget(size_t step) {
+    m_inputs.erase(std::remove_if(m_inputs.begin(), m_inputs.end(),
+                                  [step](const Input& i) { return i.step > step; }), m_inputs.end());
+    m_keyframes.erase(m_keyframes.upper_bound(step), m_keyframes.end());
+}
+
+void Timeline::thin() {
+    if (m_interval < m_maxInterval) {
+        m_interval = std::min(m_interval * 2, m_maxInterval);
+        // always keep the first, or there'd be nothing to seek to before the next
+        for (auto it = std::next(m_keyframes.begin()); it != m_keyframes.end();) {
+            if (!it->second.pinned && it->first % m_interval != 0) it = m_keyframes.erase(it);
+            else ++it;
+        }
+    }
+    // pinned keyframes (and keyframes at the longest interval) still add up, so the oldest history goes
+    while (m_keyframes.size() > std::max<size_t>(m_maxKeyframes, 2)) m_keyframes.erase(m_keyframes.begin());
+    const size_t first = m_keyframes.begin()->first;
+    m_inputs.erase(m_inputs.begin(), std::lower_bound(m_inputs.begin(), m_inputs.end(), first,
+                                                      [](const Input& i, size_t s) { return i.step < s; }));
+}
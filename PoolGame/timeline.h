@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QByteArray>
+#include <QVector2D>
+#include <map>
+#include <vector>
+#include "game.h"
+
+/**
+ * @brief The Timeline class
+ * Lets the player scrub back & forth through a session. The simulation is deterministic
+ *  (every game has its own random source), so we only keep a snapshot every so many steps,
+ *  along with every input. Seeking restores the nearest earlier keyframe, and re-simulates the
+ *  steps up to the target, replaying the inputs that happened along the way.
+ *
+ * Keyframes are thinned out (and their interval doubled, up to maxInterval) whenever there are too many.
+ *  Once the interval is as long as it goes, or pinned keyframes fill up the rest, the oldest history is
+ *  forgotten instead. So there are never more than maxKeyframes snapshots however long the session goes
+ *  for, and a seek never re-simulates more than maxInterval steps.
+ */
+class Timeline {
+public:
+    // something the player did, applied right before its step is simulated
+    struct Input {
+        enum Type { CueShot, AddBall, SwitchMode };
+        size_t step;
+        Type type;
+        // where the cue ball was shot from, and how fast (CueShot only)
+        QVector2D position;
+        QVector2D velocity;
+        // how many balls were added (AddBall only)
+        size_t count;
+    };
+
+    /**
+     * @param interval - steps between keyframes
+     * @param maxKeyframes - most keyframes to hold before they get thinned out (at least 2)
+     * @param maxInterval - longest the interval gets from thinning, keep it a power of two times interval
+     */
+    Timeline(size_t interval = 100, size_t maxKeyframes = 128, size_t maxInterval = 3200) :
+        m_interval(interval), m_maxKeyframes(maxKeyframes), m_maxInterval(maxInterval) {}
+
+    /**
+     * @brief reset - forget everything that is after the step, and keyframe the game there.
+     *  Used whenever the game is replaced by something we can't re-simulate (i.e. undo, checkpoints)
+     * @param step - the step the game is at
+     * @param game - the game
+     */
+    void reset(size_t step, Game& game);
+
+    /**
+     * @brief stepped - the game has just been simulated up until the step, keyframe it if it's time to
+     * @param step - the step the game is at now
+     * @param game - the game
+     */
+    void stepped(size_t step, Game& game);
+
+    /**
+     * @brief record - log something the player did. anything after it is a different future, so it's forgotten
+     * @param input - the input, at the step that is about to be simulated
+     */
+    void record(const Input& input);
+
+    /**
+     * @brief replay - apply the logged inputs of a step, i.e. when playing forward again after seeking back
+     * @param step - the step about to be simulated
+     * @param game - the game to apply them to
+     */
+    void replay(size_t step, Game& game) const;
+
+    /**
+     * @brief seek - recreate the game at the step
+     * @param step - the step to go to, clamped to end()
+     * @param dt - the timestep the game is simulated at
+     * @return the game before the step's inputs are replayed, or nullptr if there's nothing to seek from
+     */
+    Game* seek(size_t step, double dt) const;
+
+    /* the earliest step that can still be sought to */
+    size_t begin() const { return m_keyframes.empty() ? m_end : m_keyframes.begin()->first; }
+    /* the furthest step we know what happens up until */
+    size_t end() const { return m_end; }
+
+private:
+    struct Keyframe {
+        QByteArray state;
+        // keyframes of discontinuities (i.e. undo) can't be recreated, so they are never thinned out
+        //  (only forgotten along with the oldest history)
+        bool pinned;
+    };
+
+    size_t m_interval;
+    size_t m_maxKeyframes;
+    size_t m_maxInterval;
+    size_t m_end = 0;
+    // keyframes by step
+    std::map<size_t, Keyframe> m_keyframes;
+    // inputs in the order they happened
+    std::vector<Input> m_inputs;
+
+    /**
+     * @brief apply - make the game do what the player did
+     */
+    static void apply(const Input& input, Game& game);
+
+    /**
+     * @brief forget - drop everything that happens after the step
+     */
+    void forget(size_t step);
+
+    /**
+     * @brief thin - drop every other keyframe that isn't pinned, and double the interval.
+     *  If that isn't enough (or can't be done), forget the oldest keyframes, and the inputs before them
+     */
+    void thin();
+};
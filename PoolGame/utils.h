@@ -10,6 +10,17 @@
 
 /* filename of the config file */
 constexpr char config_path[] = "../../../../Poolgame/config.json";
+/* filename of the compiled config, rebuilt whenever the config changes */
+constexpr char scenario_cache_path[] = "config.scenario";
+/* filename of the checkpoint that saving (F5) writes, and loading (F9) resumes */
+constexpr char checkpoint_path[] = "game.checkpoint";
+
+/* how many balls are added at once when pressed B */
+constexpr size_t bulkSpawnCount = 100;
+
+/* --check-allocations: the steps played before checking, and how many are checked by default */
+constexpr int allocationWarmup = 100;
+constexpr int allocationCheckSteps = 1000;
 
 constexpr int animFrameMS = 10;
 constexpr int drawFrameMS = 10;
@@ -3,4 +3,5 @@
 std::vector<Pocket *> *TableVisiter::visitTable(Table *table)
 {
     m_pockets = table->accept(this);
+    return m_pockets;
 }